@@ -0,0 +1,251 @@
+/**
+ * @file average-kernel.cpp
+ * @description area-weighted colour averaging of sibling nodes
+ *
+ * Sums are taken in 64-bit integers by the scalar code and in double
+ * precision by the vector paths. A child's area is below 2^31, so every
+ * product and sum is an integer below 2^41 and is exact in a double. The
+ * quotient of two such integers is never rounded across an integer, so
+ * truncating it gives the same result as integer division.
+ */
+
+#include <cstdint>
+#include "average-kernel.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define AVERAGE_KERNEL_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * Area-weighted average of up to four child colours, truncated to
+ * integers exactly like QTree's constant-time node averages.
+ * @param children child colours in NW, NE, SW, SE order; nullptr if absent.
+ * @param area pixel count of each present child.
+ * @return an opaque pixel holding the average colour.
+ */
+RGBAPixel WeightedAverage(const RGBAPixel* const children[4], const int area[4]) {
+	int64_t red = 0;
+	int64_t green = 0;
+	int64_t blue = 0;
+	int64_t totalArea = 0;
+
+	for (int i = 0; i < 4; i++) {
+		if (children[i] != nullptr) {
+			red += (int64_t) children[i]->r * area[i];
+			green += (int64_t) children[i]->g * area[i];
+			blue += (int64_t) children[i]->b * area[i];
+			totalArea += area[i];
+		}
+	}
+
+	return RGBAPixel((int) (red / totalArea), (int) (green / totalArea), (int) (blue / totalArea));
+}
+
+SiblingBatch::SiblingBatch() {
+	count = 0;
+}
+
+/**
+ * Empties the batch and makes room for groups sibling groups, with
+ * every child slot marked absent.
+ */
+void SiblingBatch::Reset(size_t groups) {
+	count = groups;
+	for (int slot = 0; slot < 4; slot++) {
+		red[slot].assign(groups, 0);
+		green[slot].assign(groups, 0);
+		blue[slot].assign(groups, 0);
+		area[slot].assign(groups, 0);
+	}
+	avgRed.assign(groups, 0);
+	avgGreen.assign(groups, 0);
+	avgBlue.assign(groups, 0);
+}
+
+/**
+ * Fills child slot (0 = NW, 1 = NE, 2 = SW, 3 = SE) of a group.
+ */
+void SiblingBatch::Set(size_t group, unsigned int slot, const RGBAPixel& avg, int childArea) {
+	red[slot][group] = avg.r;
+	green[slot][group] = avg.g;
+	blue[slot][group] = avg.b;
+	area[slot][group] = childArea;
+}
+
+/**
+ * Computes the average of every group in the batch.
+ * @pre every group has at least one child.
+ */
+void SiblingBatch::Compute() {
+	size_t done = 0;
+#ifdef AVERAGE_KERNEL_X86
+	static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+	static const bool hasSSE41 = __builtin_cpu_supports("sse4.1");
+	if (hasAVX2) {
+		done = ComputeAVX2(0);
+	} else if (hasSSE41) {
+		done = ComputeSSE41(0);
+	}
+#endif
+	ComputeScalar(done, count);
+}
+
+/**
+ * Average of a group, as an opaque pixel.
+ * @pre Compute has been called since the group was last changed.
+ */
+RGBAPixel SiblingBatch::Average(size_t group) const {
+	return RGBAPixel(avgRed[group], avgGreen[group], avgBlue[group]);
+}
+
+/**
+ * Number of groups in the batch.
+ */
+size_t SiblingBatch::Size() const {
+	return count;
+}
+
+/**
+ * Averages groups [begin, end) one at a time.
+ */
+void SiblingBatch::ComputeScalar(size_t begin, size_t end) {
+	for (size_t i = begin; i < end; i++) {
+		int64_t r = 0;
+		int64_t g = 0;
+		int64_t b = 0;
+		int64_t totalArea = 0;
+		for (int slot = 0; slot < 4; slot++) {
+			r += (int64_t) red[slot][i] * area[slot][i];
+			g += (int64_t) green[slot][i] * area[slot][i];
+			b += (int64_t) blue[slot][i] * area[slot][i];
+			totalArea += area[slot][i];
+		}
+		avgRed[i] = (unsigned char) (r / totalArea);
+		avgGreen[i] = (unsigned char) (g / totalArea);
+		avgBlue[i] = (unsigned char) (b / totalArea);
+	}
+}
+
+#ifdef AVERAGE_KERNEL_X86
+
+namespace {
+	/**
+	 * Area-weighted channel sums and total area of two groups, each
+	 * product taken in double precision.
+	 */
+	__attribute__((target("sse4.1")))
+	void SumSSE41(const vector<int>* const red, const vector<int>* const green, const vector<int>* const blue,
+		const vector<int>* const area, size_t i, __m128d& r, __m128d& g, __m128d& b, __m128d& total) {
+		r = _mm_setzero_pd();
+		g = _mm_setzero_pd();
+		b = _mm_setzero_pd();
+		total = _mm_setzero_pd();
+		for (int slot = 0; slot < 4; slot++) {
+			__m128d a = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*) &area[slot][i]));
+			r = _mm_add_pd(r, _mm_mul_pd(_mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*) &red[slot][i])), a));
+			g = _mm_add_pd(g, _mm_mul_pd(_mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*) &green[slot][i])), a));
+			b = _mm_add_pd(b, _mm_mul_pd(_mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*) &blue[slot][i])), a));
+			total = _mm_add_pd(total, a);
+		}
+	}
+
+	/**
+	 * Area-weighted channel sums and total area of four groups, each
+	 * product taken in double precision.
+	 */
+	__attribute__((target("avx2")))
+	void SumAVX2(const vector<int>* const red, const vector<int>* const green, const vector<int>* const blue,
+		const vector<int>* const area, size_t i, __m256d& r, __m256d& g, __m256d& b, __m256d& total) {
+		r = _mm256_setzero_pd();
+		g = _mm256_setzero_pd();
+		b = _mm256_setzero_pd();
+		total = _mm256_setzero_pd();
+		for (int slot = 0; slot < 4; slot++) {
+			__m256d a = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*) &area[slot][i]));
+			r = _mm256_add_pd(r, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*) &red[slot][i])), a));
+			g = _mm256_add_pd(g, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*) &green[slot][i])), a));
+			b = _mm256_add_pd(b, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*) &blue[slot][i])), a));
+			total = _mm256_add_pd(total, a);
+		}
+	}
+
+	/**
+	 * Truncated quotients of four sums by four totals, given as two
+	 * pairs, packed into the low four bytes.
+	 */
+	__attribute__((target("sse4.1")))
+	int DivideSSE41(__m128d sumLow, __m128d totalLow, __m128d sumHigh, __m128d totalHigh) {
+		__m128i quotients = _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_div_pd(sumLow, totalLow)),
+			_mm_cvttpd_epi32(_mm_div_pd(sumHigh, totalHigh)));
+		// quotients are in [0, 255], so the saturating packs are exact
+		__m128i zero = _mm_setzero_si128();
+		return _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packus_epi32(quotients, zero), zero));
+	}
+
+	/**
+	 * Truncated quotients of eight sums by eight totals, given as two
+	 * quadruples, packed into the low eight bytes.
+	 */
+	__attribute__((target("avx2")))
+	__m128i DivideAVX2(__m256d sumLow, __m256d totalLow, __m256d sumHigh, __m256d totalHigh) {
+		__m128i words = _mm_packus_epi32(_mm256_cvttpd_epi32(_mm256_div_pd(sumLow, totalLow)),
+			_mm256_cvttpd_epi32(_mm256_div_pd(sumHigh, totalHigh)));
+		return _mm_packus_epi16(words, words);
+	}
+}
+
+/**
+ * Averages groups from begin four at a time; returns the first group
+ * left for ComputeScalar.
+ */
+__attribute__((target("sse4.1")))
+size_t SiblingBatch::ComputeSSE41(size_t begin) {
+	size_t i = begin;
+	for (; i + 4 <= count; i += 4) {
+		__m128d r[2], g[2], b[2], total[2];
+		SumSSE41(red, green, blue, area, i, r[0], g[0], b[0], total[0]);
+		SumSSE41(red, green, blue, area, i + 2, r[1], g[1], b[1], total[1]);
+
+		int outR = DivideSSE41(r[0], total[0], r[1], total[1]);
+		int outG = DivideSSE41(g[0], total[0], g[1], total[1]);
+		int outB = DivideSSE41(b[0], total[0], b[1], total[1]);
+		for (int k = 0; k < 4; k++) {
+			avgRed[i + k] = (unsigned char) (outR >> (8 * k));
+			avgGreen[i + k] = (unsigned char) (outG >> (8 * k));
+			avgBlue[i + k] = (unsigned char) (outB >> (8 * k));
+		}
+	}
+	return i;
+}
+
+/**
+ * Averages groups from begin eight at a time; returns the first group
+ * left for ComputeScalar.
+ */
+__attribute__((target("avx2")))
+size_t SiblingBatch::ComputeAVX2(size_t begin) {
+	size_t i = begin;
+	for (; i + 8 <= count; i += 8) {
+		__m256d r[2], g[2], b[2], total[2];
+		SumAVX2(red, green, blue, area, i, r[0], g[0], b[0], total[0]);
+		SumAVX2(red, green, blue, area, i + 4, r[1], g[1], b[1], total[1]);
+
+		_mm_storel_epi64((__m128i*) &avgRed[i], DivideAVX2(r[0], total[0], r[1], total[1]));
+		_mm_storel_epi64((__m128i*) &avgGreen[i], DivideAVX2(g[0], total[0], g[1], total[1]));
+		_mm_storel_epi64((__m128i*) &avgBlue[i], DivideAVX2(b[0], total[0], b[1], total[1]));
+	}
+	return ComputeSSE41(i);
+}
+
+#else
+
+size_t SiblingBatch::ComputeSSE41(size_t begin) {
+	return begin;
+}
+
+size_t SiblingBatch::ComputeAVX2(size_t begin) {
+	return begin;
+}
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * @file average-kernel.h
+ * @description area-weighted colour averaging of sibling nodes, one group
+ *              at a time or in SIMD batches
+ */
+
+#ifndef _AVERAGE_KERNEL_H_
+#define _AVERAGE_KERNEL_H_
+
+#include <cstddef>
+#include <vector>
+#include "cs221util/RGBAPixel.h"
+
+using namespace std;
+using namespace cs221util;
+
+/**
+ * Area-weighted average of up to four child colours, truncated to
+ * integers exactly like QTree's constant-time node averages. Sums are
+ * taken in 64 bits, so any image of fewer than 2^31 pixels is exact.
+ * @param children child colours in NW, NE, SW, SE order; nullptr if absent.
+ * @param area pixel count of each present child.
+ * @return an opaque pixel holding the average colour.
+ */
+RGBAPixel WeightedAverage(const RGBAPixel* const children[4], const int area[4]);
+
+/**
+ * SiblingBatch: the children of many nodes, stored channel by channel so
+ * that Compute can average several groups per instruction.
+ *
+ * Compute uses AVX2 or SSE4.1 when the CPU has them and plain integer
+ * code otherwise; every path produces the same values as WeightedAverage,
+ * for child areas up to 2^31 - 1 pixels.
+ */
+class SiblingBatch {
+public:
+    SiblingBatch();
+
+    /**
+     * Empties the batch and makes room for groups sibling groups, with
+     * every child slot marked absent.
+     */
+    void Reset(size_t groups);
+
+    /**
+     * Fills child slot (0 = NW, 1 = NE, 2 = SW, 3 = SE) of a group.
+     */
+    void Set(size_t group, unsigned int slot, const RGBAPixel& avg, int childArea);
+
+    /**
+     * Computes the average of every group in the batch.
+     * @pre every group has at least one child.
+     */
+    void Compute();
+
+    /**
+     * Average of a group, as an opaque pixel.
+     * @pre Compute has been called since the group was last changed.
+     */
+    RGBAPixel Average(size_t group) const;
+
+    /**
+     * Number of groups in the batch.
+     */
+    size_t Size() const;
+
+private:
+    size_t count;                // groups in the batch
+    vector<int> red[4];          // child red by slot, then by group
+    vector<int> green[4];        // child green by slot, then by group
+    vector<int> blue[4];         // child blue by slot, then by group
+    vector<int> area[4];         // child area by slot, then by group; 0 if absent
+    vector<unsigned char> avgRed;   // computed red of each group
+    vector<unsigned char> avgGreen; // computed green of each group
+    vector<unsigned char> avgBlue;  // computed blue of each group
+
+    /**
+     * Averages groups [begin, end) one at a time.
+     */
+    void ComputeScalar(size_t begin, size_t end);
+
+    /**
+     * Average groups from begin, several per step; return the first
+     * group left for ComputeScalar.
+     */
+    size_t ComputeSSE41(size_t begin);
+    size_t ComputeAVX2(size_t begin);
+};
+
+#endif
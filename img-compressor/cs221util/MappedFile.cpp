@@ -0,0 +1,98 @@
+/**
+ * @file MappedFile.cpp
+ * Implementation of memory-mapped file input.
+ */
+
+#include <cstdlib>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "MappedFile.h"
+
+namespace cs221util {
+  MappedFile::MappedFile(string const & fileName)
+      : data_(NULL), size_(0), mapped_(false), error_(0) {
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+      error_ = 78; // failed to open file for reading
+      return;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+      void * mapping = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping != MAP_FAILED) {
+        data_ = static_cast<unsigned char *>(mapping);
+        size_ = (size_t) info.st_size;
+        mapped_ = true;
+        madvise(mapping, size_, MADV_SEQUENTIAL);
+      }
+    }
+
+    if (!mapped_) {
+      readAll(fd);
+    }
+    close(fd);
+  }
+
+  MappedFile::~MappedFile() {
+    if (mapped_) {
+      munmap(data_, size_);
+    } else {
+      free(data_);
+    }
+  }
+
+  unsigned char const * MappedFile::data() const {
+    return data_;
+  }
+
+  size_t MappedFile::size() const {
+    return size_;
+  }
+
+  bool MappedFile::mapped() const {
+    return mapped_;
+  }
+
+  unsigned MappedFile::error() const {
+    return error_;
+  }
+
+  void MappedFile::readAll(int fd) {
+    size_t capacity = 0;
+    while (true) {
+      if (size_ == capacity) {
+        capacity = capacity ? capacity * 2 : 65536;
+        unsigned char * grown = static_cast<unsigned char *>(realloc(data_, capacity));
+        if (!grown) {
+          error_ = 83; // memory allocation failed
+          break;
+        }
+        data_ = grown;
+      }
+
+      ssize_t got = read(fd, data_ + size_, capacity - size_);
+      if (got < 0 && errno == EINTR) {
+        continue;
+      }
+      if (got < 0) {
+        error_ = 78;
+        break;
+      }
+      if (got == 0) {
+        break;
+      }
+      size_ += (size_t) got;
+    }
+
+    // an empty or unreadable file has no contents, as data() promises
+    if (error_ || size_ == 0) {
+      free(data_);
+      data_ = NULL;
+      size_ = 0;
+    }
+  }
+}
@@ -0,0 +1,76 @@
+/**
+ * @file MappedFile.h
+ * Read-only access to the whole contents of a file, memory-mapped when
+ * the file allows it.
+ */
+
+#ifndef CS221_MAPPEDFILE_H_
+#define CS221_MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+
+using namespace std;
+
+namespace cs221util {
+  /**
+   * MappedFile: the bytes of a file, for decoding in place. A regular
+   * file is mapped read-only and advised for sequential access, so its
+   * pages are shared with the page cache rather than copied into a
+   * second buffer. Pipes, devices and files that cannot be mapped are
+   * read to the end into an allocated buffer instead.
+   */
+  class MappedFile {
+  public:
+    /**
+      * Opens a file and maps or reads its contents.
+      * @param fileName Name of the file to be read from.
+      */
+    MappedFile(string const & fileName);
+
+    /**
+      * Unmaps or frees the contents.
+      */
+    ~MappedFile();
+
+    /**
+      * Gets the contents of the file, or NULL if it is empty or could
+      * not be read.
+      */
+    unsigned char const * data() const;
+
+    /**
+      * Gets the number of bytes in the file, or 0 if it could not be read.
+      */
+    size_t size() const;
+
+    /**
+      * Gets whether the contents are memory-mapped rather than copied.
+      */
+    bool mapped() const;
+
+    /**
+      * Gets the lodepng error code of a failed read, or 0 if none. A file
+      * that cannot be opened or read gives error 78, as lodepng_load_file
+      * does, and a failed allocation gives error 83.
+      */
+    unsigned error() const;
+
+  private:
+    unsigned char * data_;        /*< Contents of the file */
+    size_t size_;                 /*< Number of bytes in the file */
+    bool mapped_;                 /*< Whether data_ is a mapping or a malloc'd buffer */
+    unsigned error_;              /*< Read error, or 0 */
+
+    MappedFile(MappedFile const & other);             // not copyable
+    MappedFile & operator=(MappedFile const & other); // not assignable
+
+    /**
+      * Reads an open descriptor to its end into a malloc'd buffer. Leaves
+      * data_ NULL and size_ 0 if nothing was read or the read failed.
+      */
+    void readAll(int fd);
+  };
+}
+
+#endif
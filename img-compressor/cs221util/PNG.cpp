@@ -11,19 +11,51 @@
 #include <algorithm>
 #include <functional>
 #include <cassert>
+#include <cstdlib>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unistd.h>
 #include "lodepng/lodepng.h"
 #include "PNG.h"
+#include "MappedFile.h"
 //#include "RGB_HSL.h"
 
+#ifdef __SSE2__
+#define PNG_COMPARE_SSE2 1
+#include <emmintrin.h>
+#endif
+
 namespace cs221util {
+  namespace {
+    static_assert(std::is_trivially_destructible<RGBAPixel>::value, "pixel arrays are released with free");
+
+    /**
+     * Allocates count default pixels. Pixel arrays are kept in malloc'd
+     * memory, released with free, so that readFromMemory can grow
+     * lodepng's own output buffer into one with realloc.
+     */
+    RGBAPixel * allocatePixels(size_t count) {
+      RGBAPixel * pixels = static_cast<RGBAPixel *>(malloc(std::max<size_t>(count, 1) * sizeof(RGBAPixel)));
+      if (pixels == NULL) {
+        throw std::bad_alloc();
+      }
+      std::uninitialized_fill_n(pixels, count, RGBAPixel());
+      return pixels;
+    }
+  }
+
   void PNG::_copy(PNG const & other) {
     // Clear self
-    delete[] imageData_;
+    free(imageData_);
 
     // Copy `other` to self
     width_ = other.width_;
     height_ = other.height_;
-    imageData_ = new RGBAPixel[width_ * height_];
+    imageData_ = allocatePixels((size_t) width_ * height_);
     for (unsigned i = 0; i < width_ * height_; i++) {
       imageData_[i] = other.imageData_[i];
     }
@@ -38,7 +70,7 @@ namespace cs221util {
   PNG::PNG(unsigned int width, unsigned int height) {
     width_ = width;
     height_ = height;
-    imageData_ = new RGBAPixel[width * height];
+    imageData_ = allocatePixels((size_t) width * height);
   }
 
   PNG::PNG(PNG const & other) {
@@ -46,8 +78,17 @@ namespace cs221util {
     _copy(other);
   }
 
+  PNG::PNG(PNG && other) noexcept {
+    width_ = other.width_;
+    height_ = other.height_;
+    imageData_ = other.imageData_;
+    other.width_ = 0;
+    other.height_ = 0;
+    other.imageData_ = NULL;
+  }
+
   PNG::~PNG() {
-    delete[] imageData_;
+    free(imageData_);
   }
 
   PNG const & PNG::operator=(PNG const & other) {
@@ -55,17 +96,167 @@ namespace cs221util {
     return *this;
   }
 
+  PNG const & PNG::operator=(PNG && other) noexcept {
+    if (this != &other) {
+      free(imageData_);
+      width_ = other.width_;
+      height_ = other.height_;
+      imageData_ = other.imageData_;
+      other.width_ = 0;
+      other.height_ = 0;
+      other.imageData_ = NULL;
+    }
+    return *this;
+  }
+
+  void PNG::swap(PNG & other) noexcept {
+    std::swap(width_, other.width_);
+    std::swap(height_, other.height_);
+    std::swap(imageData_, other.imageData_);
+  }
+
+  void swap(PNG & a, PNG & b) noexcept {
+    a.swap(b);
+  }
+
+  namespace {
+#ifdef PNG_COMPARE_SSE2
+    // the kernels load each pixel as r, g, b, padding, then alpha
+    static_assert(sizeof(RGBAPixel) == 16 && offsetof(RGBAPixel, a) == 8,
+                  "pixels must hold three channel bytes and then a double alpha");
+#endif
+
+    /**
+     * Compares pixels a[0], a[1] with b[0], b[1] as RGBAPixel::operator==
+     * does: bit k of the result is set if a[k] != b[k].
+     */
+    unsigned tolerantMismatches(RGBAPixel const * a, RGBAPixel const * b) {
+#ifdef PNG_COMPARE_SSE2
+      __m128i a0 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(a));
+      __m128i a1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(a + 1));
+      __m128i b0 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(b));
+      __m128i b1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(b + 1));
+
+      // channels: |a - b| > 2 in any of r, g, b (bytes 0-2 and 8-10)
+      __m128i channelsA = _mm_unpacklo_epi64(a0, a1);
+      __m128i channelsB = _mm_unpacklo_epi64(b0, b1);
+      __m128i distance = _mm_or_si128(_mm_subs_epu8(channelsA, channelsB), _mm_subs_epu8(channelsB, channelsA));
+      int close = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_subs_epu8(distance, _mm_set1_epi8(2)), _mm_setzero_si128()));
+      unsigned channels = ((close & 0x007) != 0x007) | ((close & 0x700) != 0x700) << 1;
+
+      // alpha: |a - b| > 0.01, unless a's alpha is 0
+      __m128d alphaA = _mm_castsi128_pd(_mm_unpackhi_epi64(a0, a1));
+      __m128d alphaB = _mm_castsi128_pd(_mm_unpackhi_epi64(b0, b1));
+      __m128d alphaDistance = _mm_andnot_pd(_mm_set1_pd(-0.0), _mm_sub_pd(alphaA, alphaB));
+      unsigned alpha = _mm_movemask_pd(_mm_cmpgt_pd(alphaDistance, _mm_set1_pd(0.01)));
+      unsigned transparent = _mm_movemask_pd(_mm_cmpeq_pd(alphaA, _mm_setzero_pd()));
+
+      return (channels | alpha) & ~transparent;
+#else
+      return (a[0] != b[0]) | (a[1] != b[1]) << 1;
+#endif
+    }
+
+    /**
+     * Compares pixels a[0], a[1] with b[0], b[1] field by field: bit k of
+     * the result is set if a[k] and b[k] differ in any channel or alpha.
+     */
+    unsigned exactMismatches(RGBAPixel const * a, RGBAPixel const * b) {
+#ifdef PNG_COMPARE_SSE2
+      __m128i a0 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(a));
+      __m128i a1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(a + 1));
+      __m128i b0 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(b));
+      __m128i b1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(b + 1));
+
+      int same = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_unpacklo_epi64(a0, a1), _mm_unpacklo_epi64(b0, b1)));
+      unsigned channels = ((same & 0x007) != 0x007) | ((same & 0x700) != 0x700) << 1;
+      unsigned alpha = _mm_movemask_pd(_mm_cmpneq_pd(_mm_castsi128_pd(_mm_unpackhi_epi64(a0, a1)),
+                                                     _mm_castsi128_pd(_mm_unpackhi_epi64(b0, b1))));
+      return channels | alpha;
+#else
+      unsigned mismatches = 0;
+      for (unsigned k = 0; k < 2; k++) {
+        if (a[k].r != b[k].r || a[k].g != b[k].g || a[k].b != b[k].b || a[k].a != b[k].a) {
+          mismatches |= 1u << k;
+        }
+      }
+      return mismatches;
+#endif
+    }
+
+    /**
+     * Whether count pixels of a and b all match under the given pair
+     * comparison, stopping at the first block with a mismatch.
+     */
+    bool allMatch(RGBAPixel const * a, RGBAPixel const * b, size_t count,
+                  unsigned (*mismatches)(RGBAPixel const *, RGBAPixel const *)) {
+      size_t i = 0;
+      for (; i + 4 <= count; i += 4) {
+        if (mismatches(a + i, b + i) | mismatches(a + i + 2, b + i + 2)) {
+          return false;
+        }
+      }
+      for (; i < count; i += 2) {
+        // an odd last pixel is compared with itself as the second of the pair
+        size_t second = i + 1 < count ? 1 : 0;
+        RGBAPixel const pairA[2] = {a[i], a[i + second]};
+        RGBAPixel const pairB[2] = {b[i], b[i + second]};
+        if (mismatches(pairA, pairB)) {
+          return false;
+        }
+      }
+      return true;
+    }
+  }
+
   bool PNG::operator==(PNG const & other) const {
     if (width_ != other.width_) { return false; }
     if (height_ != other.height_) { return false; }
 
-    for (unsigned i = 0; i < width_ * height_; i++) {
-      RGBAPixel & p1 = imageData_[i];
-      RGBAPixel & p2 = other.imageData_[i];
-      if (p1 != p2) { return false; }
+    return allMatch(imageData_, other.imageData_, (size_t) width_ * height_, tolerantMismatches);
+  }
+
+  bool PNG::identical(PNG const & other) const {
+    if (width_ != other.width_) { return false; }
+    if (height_ != other.height_) { return false; }
+
+    return allMatch(imageData_, other.imageData_, (size_t) width_ * height_, exactMismatches);
+  }
+
+  PNGDiff PNG::diff(PNG const & other) const {
+    PNGDiff report = {0, 0, 0, 0, 0};
+    unsigned width = std::min(width_, other.width_);
+    unsigned height = std::min(height_, other.height_);
+
+    for (unsigned y = 0; y < height; y++) {
+      RGBAPixel const * rowA = row(y);
+      RGBAPixel const * rowB = other.row(y);
+      for (unsigned x = 0; x < width; x += 2) {
+        unsigned mismatches;
+        if (x + 1 < width) {
+          mismatches = tolerantMismatches(rowA + x, rowB + x);
+        } else {
+          mismatches = rowA[x] != rowB[x];
+        }
+
+        for (unsigned k = 0; k < 2; k++) {
+          if (!(mismatches & (1u << k))) {
+            continue;
+          }
+          if (report.count == 0) {
+            report.left = report.right = x + k;
+            report.top = report.bottom = y;
+          } else {
+            report.left = std::min(report.left, x + k);
+            report.right = std::max(report.right, x + k);
+            report.bottom = y;
+          }
+          report.count++;
+        }
+      }
     }
 
-    return true;
+    return report;
   }
 
   bool PNG::operator!=(PNG const & other) const {
@@ -98,24 +289,89 @@ namespace cs221util {
   }
 
   bool PNG::readFromFile(string const & fileName) {
-    vector<unsigned char> byteData;
-    unsigned error = lodepng::decode(byteData, width_, height_, fileName);
+    // The file is decoded straight from its mapping where possible.
+    MappedFile file(fileName);
+    if (file.error()) {
+      cerr << "PNG decoder error " << file.error() << ": " << lodepng_error_text(file.error()) << endl;
+      return false;
+    }
+    return readFromMemory(file.data(), file.size());
+  }
 
+  bool PNG::readFromMemory(unsigned char const * data, size_t size) {
+    // Decode in the file's own colour type, then convert to RGBA8 straight
+    // into the front of the new pixel array and widen it in place, so no
+    // separate full-frame RGBA8 buffer is made from a narrower image.
+    // lodepng always allocates its own output, so for a file that is
+    // already RGBA8 that output is itself a full-frame RGBA8 buffer. It is
+    // grown into the pixel array with realloc, which for a large block
+    // usually extends or remaps it rather than copying, and widened in
+    // place, so the RGBA8 image and the pixel array are not both held.
+    unsigned char * raw = NULL;
+    unsigned width = 0;
+    unsigned height = 0;
+    LodePNGState state;
+    lodepng_state_init(&state);
+    state.decoder.color_convert = 0;
+
+    unsigned error = lodepng_decode(&raw, &width, &height, &state, data, size);
     if (error) {
       cerr << "PNG decoder error " << error << ": " << lodepng_error_text(error) << endl;
+      free(raw);
+      lodepng_state_cleanup(&state);
       return false;
     }
 
-    delete[] imageData_;
-    imageData_ = new RGBAPixel[width_ * height_];
+    free(imageData_);
+    width_ = width;
+    height_ = height;
+    size_t count = (size_t) width_ * height_;
+
+    if (state.info_png.color.colortype == LCT_RGBA && state.info_png.color.bitdepth == 8) {
+      lodepng_state_cleanup(&state);
+      imageData_ = static_cast<RGBAPixel *>(realloc(raw, std::max<size_t>(count, 1) * sizeof(RGBAPixel)));
+      if (imageData_ == NULL) {
+        free(raw);
+        width_ = 0;
+        height_ = 0;
+        throw std::bad_alloc();
+      }
+      // As below, working back to front reads each pixel's bytes before
+      // any wider pixel is written over them.
+      unsigned char const * rgba = reinterpret_cast<unsigned char const *>(imageData_);
+      for (size_t i = count; i-- > 0; ) {
+        RGBAPixel pixel(rgba[4 * i], rgba[4 * i + 1], rgba[4 * i + 2], rgba[4 * i + 3]/255.);
+        new (imageData_ + i) RGBAPixel(pixel);
+      }
+      return true;
+    }
 
-    for (unsigned i = 0; i < byteData.size(); i += 4) {
-      RGBAPixel & pixel = imageData_[i/4];
-      pixel.r = byteData[i];
-      pixel.g = byteData[i + 1];
-      pixel.b = byteData[i + 2];
-      pixel.a = byteData[i + 3]/255.;
+    imageData_ = allocatePixels(count);
+
+    LodePNGColorMode rgba8;
+    lodepng_color_mode_init(&rgba8);
+    rgba8.colortype = LCT_RGBA;
+    rgba8.bitdepth = 8;
+    unsigned char * byteData = reinterpret_cast<unsigned char *>(imageData_);
+    error = lodepng_convert(byteData, raw, &rgba8, &state.info_png.color, width_, height_);
+    free(raw);
+    lodepng_color_mode_cleanup(&rgba8);
+    lodepng_state_cleanup(&state);
+
+    if (error) {
+      cerr << "PNG decoder error " << error << ": " << lodepng_error_text(error) << endl;
+      for (unsigned i = 0; i < width_ * height_; i++) {
+        imageData_[i] = RGBAPixel();
+      }
+      return false;
+    }
 
+    // Pixel i's four bytes sit at 4i, at or below the slot it widens into,
+    // so working back to front never overwrites bytes still to be read.
+    static_assert(sizeof(RGBAPixel) >= 4, "pixels must be at least as wide as RGBA8");
+    for (size_t i = (size_t) width_ * height_; i-- > 0; ) {
+      RGBAPixel pixel(byteData[4 * i], byteData[4 * i + 1], byteData[4 * i + 2], byteData[4 * i + 3]/255.);
+      imageData_[i] = pixel;
     }
 /*
     for (unsigned i = 0; i < byteData.size(); i += 4) {
@@ -138,6 +394,19 @@ namespace cs221util {
   }
 
   bool PNG::writeToFile(string const & fileName) {
+    vector<unsigned char> encoded;
+    if (!writeToMemory(encoded)) {
+      return false;
+    }
+
+    unsigned error = lodepng::save_file(encoded, fileName);
+    if (error) {
+      cerr << "PNG encoding error " << error << ": " << lodepng_error_text(error) << endl;
+    }
+    return (error == 0);
+  }
+
+  bool PNG::writeToMemory(vector<unsigned char> & out) const {
     unsigned char *byteData = new unsigned char[width_ * height_ * 4];
 /*
     for (unsigned i = 0; i < width_ * height_; i++) {
@@ -162,7 +431,8 @@ namespace cs221util {
       byteData[(i * 4) + 3] = imageData_[i].a * 255;
     }
 
-    unsigned error = lodepng::encode(fileName, byteData, width_, height_);
+    out.clear();
+    unsigned error = lodepng::encode(out, byteData, width_, height_);
     if (error) {
       cerr << "PNG encoding error " << error << ": " << lodepng_error_text(error) << endl;
     }
@@ -171,6 +441,74 @@ namespace cs221util {
     return (error == 0);
   }
 
+  bool PNG::writeToMemory(PNGSink const & sink) const {
+    vector<unsigned char> encoded;
+    if (!writeToMemory(encoded)) {
+      return false;
+    }
+    return sink(encoded.data(), encoded.size());
+  }
+
+  bool PNG::writeToStream(PNGSink const & sink) const {
+    bool alpha = false;
+    for (unsigned i = 0; i < width_ * height_ && !alpha; i++) {
+      alpha = (unsigned char) (imageData_[i].a * 255) != 255;
+    }
+
+    PNGStreamWriter writer(width_, height_, alpha, sink);
+    vector<unsigned char> row(width_ * 4);
+    for (unsigned y = 0; y < height_; y++) {
+      RGBAPixel const * pixel = &imageData_[y * width_];
+      for (unsigned x = 0; x < width_; x++) {
+        row[(x * 4)]     = pixel[x].r;
+        row[(x * 4) + 1] = pixel[x].g;
+        row[(x * 4) + 2] = pixel[x].b;
+        row[(x * 4) + 3] = pixel[x].a * 255;
+      }
+      if (!writer.writeRow(row.data())) { break; }
+    }
+
+    if (!writer.finish()) {
+      if (writer.error() != PNGStreamWriter::SINK_REFUSED) {
+        cerr << "PNG encoding error " << writer.error() << ": " << lodepng_error_text(writer.error()) << endl;
+      }
+      return false;
+    }
+    return true;
+  }
+
+  bool PNG::writeToDescriptor(int fd) const {
+    return writeToStream([fd](unsigned char const * data, size_t size) {
+      while (size > 0) {
+        ssize_t written = write(fd, data, size);
+        if (written < 0 && errno == EINTR) { continue; }
+        if (written <= 0) {
+          cerr << "PNG write error: " << strerror(errno) << endl;
+          return false;
+        }
+        data += written;
+        size -= written;
+      }
+      return true;
+    });
+  }
+
+  void PNG::fill(unsigned int left, unsigned int top, unsigned int span, unsigned int rows, RGBAPixel const & color) {
+    if (span == 0 || rows == 0) {
+      return;
+    }
+    // RGBAPixel is trivially copyable, so these copies of whole runs of
+    // pixels compile to bytewise block copies
+    RGBAPixel * first = row(top) + left;
+    *first = color;
+    for (unsigned int filled = 1; filled < span; filled *= 2) {
+      std::copy_n(first, std::min(filled, span - filled), first + filled);
+    }
+    for (unsigned int y = top + 1; y < top + rows; y++) {
+      std::copy_n(first, span, row(y) + left);
+    }
+  }
+
   unsigned int PNG::width() const {
     return width_;
   }
@@ -181,22 +519,19 @@ namespace cs221util {
 
   void PNG::resize(unsigned int newWidth, unsigned int newHeight) {
     // Create a new vector to store the image data for the new (resized) image
-    RGBAPixel * newImageData = new RGBAPixel[newWidth * newHeight];
+    RGBAPixel * newImageData = allocatePixels((size_t) newWidth * newHeight);
 
     // Copy the current data to the new image data, using the existing pixel
     // for coordinates within the bounds of the old image size
-    for (unsigned x = 0; x < newWidth; x++) {
-      for (unsigned y = 0; y < newHeight; y++) {
-        if (x < width_ && y < height_) {
-          RGBAPixel * oldPixel = this->getPixel(x, y);
-          RGBAPixel & newPixel = newImageData[ (x + (y * newWidth)) ];
-          newPixel = *oldPixel;
-        }
-      }
+    unsigned keptWidth = std::min(width_, newWidth);
+    unsigned keptHeight = std::min(height_, newHeight);
+    for (unsigned y = 0; y < keptHeight; y++) {
+      RGBAPixel const * oldRow = row(y);
+      std::copy(oldRow, oldRow + keptWidth, newImageData + (size_t) y * newWidth);
     }
 
     // Clear the existing image
-    delete[] imageData_;
+    free(imageData_);
 
     // Update the image to reflect the new image size and data
     width_ = newWidth;
@@ -204,21 +539,86 @@ namespace cs221util {
     imageData_ = newImageData;
   }
 
-  std::size_t PNG::computeHash() const {
-    std::hash<float> hashFunction;
-    std::size_t hash = 0;
+  namespace {
+    const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+    const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+    const uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+    const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+    const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
 
+    uint64_t rotl64(uint64_t value, int bits) {
+      return (value << bits) | (value >> (64 - bits));
+    }
 
-    for (unsigned x = 0; x < this->width(); x++) {
-      for (unsigned y = 0; y < this->height(); y++) {
-        RGBAPixel * pixel = this->getPixel(x, y);
-        hash = (hash << 1) + hash + hashFunction(pixel->r);
-        hash = (hash << 1) + hash + hashFunction(pixel->g);
-        hash = (hash << 1) + hash + hashFunction(pixel->b);
-        hash = (hash << 1) + hash + hashFunction(pixel->a);
+    uint64_t hashRound(uint64_t acc, uint64_t input) {
+      acc += input * PRIME64_2;
+      return rotl64(acc, 31) * PRIME64_1;
+    }
+
+    uint64_t hashMerge(uint64_t hash, uint64_t acc) {
+      hash ^= hashRound(0, acc);
+      return hash * PRIME64_1 + PRIME64_4;
+    }
+
+    // one pixel as the little-endian 32-bit word of its RGBA8 bytes
+    uint64_t packPixel(RGBAPixel const & pixel) {
+      return (uint64_t) pixel.r | (uint64_t) pixel.g << 8 | (uint64_t) pixel.b << 16
+          | (uint64_t) (unsigned char) (pixel.a * 255) << 24;
+    }
+
+    // two pixels as the little-endian 64-bit word of their RGBA8 bytes
+    uint64_t packPair(RGBAPixel const * pixels) {
+      return packPixel(pixels[0]) | packPixel(pixels[1]) << 32;
+    }
+  }
+
+  uint64_t PNG::computeHash() const {
+    return computeHash((uint64_t) width_ << 32 | height_);
+  }
+
+  uint64_t PNG::computeHash(uint64_t seed) const {
+    // XXH64 over the pixels' RGBA8 bytes, packed on the fly: eight pixels
+    // make one 32-byte stripe, split over four independent accumulators.
+    size_t count = (size_t) width_ * height_;
+    RGBAPixel const * pixels = imageData_;
+    size_t i = 0;
+    uint64_t hash;
+
+    if (count >= 8) {
+      uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+      uint64_t v2 = seed + PRIME64_2;
+      uint64_t v3 = seed;
+      uint64_t v4 = seed - PRIME64_1;
+      for (; i + 8 <= count; i += 8) {
+        v1 = hashRound(v1, packPair(pixels + i));
+        v2 = hashRound(v2, packPair(pixels + i + 2));
+        v3 = hashRound(v3, packPair(pixels + i + 4));
+        v4 = hashRound(v4, packPair(pixels + i + 6));
       }
+      hash = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+      hash = hashMerge(hash, v1);
+      hash = hashMerge(hash, v2);
+      hash = hashMerge(hash, v3);
+      hash = hashMerge(hash, v4);
+    } else {
+      hash = seed + PRIME64_5;
+    }
+
+    hash += (uint64_t) count * 4;
+    for (; i + 2 <= count; i += 2) {
+      hash ^= hashRound(0, packPair(pixels + i));
+      hash = rotl64(hash, 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (i < count) {
+      hash ^= packPixel(pixels[i]) * PRIME64_1;
+      hash = rotl64(hash, 23) * PRIME64_2 + PRIME64_3;
     }
 
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
     return hash;
   }
 
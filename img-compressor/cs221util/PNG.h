@@ -8,14 +8,28 @@
 #ifndef CS221_PNG_H_
 #define CS221_PNG_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 //#include "HSLAPixel.h"
 #include "RGBAPixel.h"
+#include "PNGStreamWriter.h"
 
 using namespace std;
 
 namespace cs221util {
+  /**
+    * Where two images differ, as reported by PNG::diff. The bounding box
+    * is inclusive, and all zero when no pixels differ.
+    */
+  struct PNGDiff {
+    size_t count;                   /*< Number of mismatched pixels */
+    unsigned int left;              /*< Leftmost column with a mismatch */
+    unsigned int top;               /*< Topmost row with a mismatch */
+    unsigned int right;             /*< Rightmost column with a mismatch */
+    unsigned int bottom;            /*< Bottommost row with a mismatch */
+  };
+
   class PNG {
   public:
     /**
@@ -37,6 +51,13 @@ namespace cs221util {
       */
     PNG(PNG const & other);
 
+    /**
+      * Move constructor: takes over the pixels of another PNG image
+      * without copying them, leaving the other image empty.
+      * @param other PNG to be moved from.
+      */
+    PNG(PNG && other) noexcept;
+
     /**
       * Destructor: frees all memory associated with a given PNG object.
       * Invoked by the system.
@@ -51,7 +72,25 @@ namespace cs221util {
     PNG const & operator= (PNG const & other);
 
     /**
-      * Equality operator: checks if two images are the same.
+      * Move assignment operator: frees the current image and takes over
+      * the pixels of another without copying them, leaving the other
+      * image empty.
+      * @param other Image to move into the current image.
+      * @return The current image for assignment chaining.
+      */
+    PNG const & operator= (PNG && other) noexcept;
+
+    /**
+      * Exchanges the contents of this image and another in constant time.
+      * @param other Image to exchange with.
+      */
+    void swap(PNG & other) noexcept;
+
+    /**
+      * Equality operator: checks if two images are the same, allowing
+      * each pixel RGBAPixel::operator=='s tolerance. Pixels are compared
+      * two at a time with SSE2 where available, stopping at the first
+      * mismatch.
       * @param other Image to be checked.
       * @return Whether the current image is equal to the other image.
       */
@@ -64,6 +103,23 @@ namespace cs221util {
       */
     bool operator!= (PNG const & other) const;
 
+    /**
+      * Exact equality: checks if two images have the same dimensions and
+      * exactly the same channel and alpha values in every pixel, with
+      * none of operator=='s tolerance.
+      * @param other Image to be checked.
+      * @return Whether every pixel of the two images is identical.
+      */
+    bool identical(PNG const & other) const;
+
+    /**
+      * Finds the pixels that differ under operator=='s per-pixel test.
+      * Only the area the two images have in common is compared.
+      * @param other Image to be checked.
+      * @return The number of differing pixels and their bounding box.
+      */
+    PNGDiff diff(PNG const & other) const;
+
 
     /**
       * Reads in a PNG image from a file.
@@ -73,6 +129,15 @@ namespace cs221util {
       */
     bool readFromFile(string const & fileName);
 
+    /**
+      * Reads in a PNG image from an encoded file held in memory, such as
+      * a request body. Overwrites any current image content in the PNG.
+      * @param data The bytes of the PNG file.
+      * @param size Number of bytes in data.
+      * @return true, if the image was successfully decoded and loaded.
+      */
+    bool readFromMemory(unsigned char const * data, size_t size);
+
     /**
       * Writes a PNG image to a file.
       * @param fileName Name of the file to be written.
@@ -80,6 +145,43 @@ namespace cs221util {
       */
     bool writeToFile(string const & fileName);
 
+    /**
+      * Encodes the image as a PNG file in memory. The bytes are exactly
+      * those writeToFile would write.
+      * @param out Buffer to hold the file; its contents are replaced.
+      * @return true, if the image was successfully encoded.
+      */
+    bool writeToMemory(vector<unsigned char> & out) const;
+
+    /**
+      * Encodes the image as writeToMemory does and hands the whole file to
+      * a sink in one piece. Unlike writeToStream, the file keeps
+      * writeToFile's smaller encoding, at the cost of one full-size buffer.
+      * @param sink Destination of the encoded bytes.
+      * @return true, if the image was successfully encoded and accepted.
+      *         A sink that refuses the data gives false with no message.
+      */
+    bool writeToMemory(PNGSink const & sink) const;
+
+    /**
+      * Writes the image as a PNG file to a sink, encoding a row at a time
+      * with PNGStreamWriter, so no full-image byte buffer is built. Alpha
+      * is stored only if some pixel is not opaque. The file decodes to the
+      * same pixels as writeToFile's, though the bytes may differ.
+      * @param sink Destination of the encoded bytes.
+      * @return true, if the image was successfully written. A sink that
+      *         refuses the data gives false with no message.
+      */
+    bool writeToStream(PNGSink const & sink) const;
+
+    /**
+      * Writes the image as a PNG file to an open file descriptor, as
+      * writeToStream does.
+      * @param fd Descriptor open for writing.
+      * @return true, if the image was successfully written.
+      */
+    bool writeToDescriptor(int fd) const;
+
     /**
       * Pixel access operator. Gets a pointer to the pixel at the given
       * coordinates in the image. (0,0) is the upper left corner.
@@ -90,6 +192,44 @@ namespace cs221util {
       */
     RGBAPixel * getPixel(unsigned int x, unsigned int y) const;
 
+    /**
+      * Unchecked pixel access. Gets a pointer to the pixel at the given
+      * coordinates without getPixel's bounds checks, warnings or
+      * clamping. Defined here so that it inlines into inner loops.
+      * @param x X-coordinate for the pixel pointer to be grabbed from.
+      * @param y Y-coordinate for the pixel pointer to be grabbed from.
+      * @return A pointer to the pixel at the given coordinates.
+      * @pre x < width() and y < height().
+      */
+    RGBAPixel * pixelAt(unsigned int x, unsigned int y) const {
+      return imageData_ + (size_t) y * width_ + x;
+    }
+
+    /**
+      * Row access. Gets a pointer to the first pixel of a row; the row's
+      * width() pixels are contiguous, left to right, so a whole scanline
+      * can be walked or copied without per-pixel calls.
+      * @param y Row to be grabbed.
+      * @return A pointer to pixel (0, y).
+      * @pre y < height().
+      */
+    RGBAPixel * row(unsigned int y) const {
+      return imageData_ + (size_t) y * width_;
+    }
+
+    /**
+      * Fills a rectangle of the image with one colour, one contiguous row
+      * span at a time: the first row is replicated by doubling copies and
+      * every other row is copied from it whole. No bounds are checked.
+      * @param left X-coordinate of the upper left corner.
+      * @param top Y-coordinate of the upper left corner.
+      * @param span Width of the rectangle.
+      * @param rows Height of the rectangle.
+      * @param color Colour to fill with.
+      * @pre left + span <= width() and top + rows <= height().
+      */
+    void fill(unsigned int left, unsigned int top, unsigned int span, unsigned int rows, RGBAPixel const & color);
+
     /**
       * Gets the width of this image.
       * @return Width of the image.
@@ -112,9 +252,20 @@ namespace cs221util {
     void resize(unsigned int newWidth, unsigned int newHeight);
 
     /**
-     * Computes a hash of the contents of the image.
+     * Computes a 64-bit hash of the contents of the image: XXH64 of its
+     * row-major RGBA8 bytes (alpha as written by writeToFile), seeded with
+     * the width and height. The value is the same on every platform and
+     * run, so it can key caches of results for identical images.
+     */
+    uint64_t computeHash() const;
+
+    /**
+     * Computes XXH64 of the same bytes as computeHash(), with the given
+     * seed in place of the image size. Hashes with different seeds are
+     * independent, so a second one can confirm a match on the first.
+     * @param seed Seed of the hash.
      */
-    std::size_t computeHash() const;
+    uint64_t computeHash(uint64_t seed) const;
 
   private:
     unsigned int width_;            /*< Width of the image */
@@ -128,6 +279,11 @@ namespace cs221util {
      void _copy(PNG const & other);
   };
 
+  /**
+    * Exchanges the contents of two images in constant time.
+    */
+  void swap(PNG & a, PNG & b) noexcept;
+
   std::ostream & operator<<(std::ostream & out, PNG const & pixel);
   std::stringstream & operator<<(std::stringstream & out, PNG const & pixel);
 }
@@ -0,0 +1,574 @@
+/**
+ * @file PNGStreamWriter.cpp
+ * Implementation of a row-at-a-time PNG encoder.
+ */
+
+#include <cstring>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <queue>
+#include "lodepng/lodepng.h"
+#include "PNGStreamWriter.h"
+
+namespace cs221util {
+  namespace {
+    // filtered rows are deflated once this many bytes are pending
+    const size_t ROW_GROUP_BYTES = 65536;
+
+    // deflate parameters: matches reach back at most one window
+    const size_t WINDOW_SIZE = 32768;
+    const size_t HASH_SIZE = 32768;
+    const size_t MIN_MATCH = 3;
+    const size_t MAX_MATCH = 258;
+    const size_t NICE_MATCH = 128;  // stop searching at a match this long
+    const unsigned MAX_CHAIN = 128; // candidates tried per position
+    const size_t NONE = SIZE_MAX;   // no earlier position
+
+    // RFC 1951 length and distance codes: first value and extra bits
+    const unsigned LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                      35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    const unsigned LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                       3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    const unsigned DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                        8193, 12289, 16385, 24577};
+    const unsigned DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                         7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    // order in which the code length code lengths are sent
+    const unsigned char CODE_LENGTH_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    unsigned lengthCode(unsigned length) {
+      return (unsigned) (upper_bound(LENGTH_BASE, LENGTH_BASE + 29, length) - LENGTH_BASE) - 1;
+    }
+
+    unsigned distanceCode(unsigned distance) {
+      return (unsigned) (upper_bound(DISTANCE_BASE, DISTANCE_BASE + 30, distance) - DISTANCE_BASE) - 1;
+    }
+
+    /**
+     * Huffman code lengths for the given symbol frequencies, none longer
+     * than maxBits. At least two symbols get a code, so the code is always
+     * complete; while the longest code is too long, the frequencies are
+     * halved (keeping every used symbol at least 1) and the code rebuilt.
+     */
+    vector<unsigned char> codeLengths(vector<size_t> frequencies, unsigned maxBits) {
+      size_t used = count_if(frequencies.begin(), frequencies.end(), [](size_t f) { return f > 0; });
+      for (size_t s = 0; used < 2 && s < frequencies.size(); s++) {
+        if (frequencies[s] == 0) {
+          frequencies[s] = 1;
+          used++;
+        }
+      }
+
+      vector<unsigned char> lengths(frequencies.size());
+      while (true) {
+        // leaves first, then internal nodes, each pointing at its parent
+        vector<int> parent;
+        vector<int> leaf(frequencies.size(), -1);
+        priority_queue<pair<size_t, int>, vector<pair<size_t, int>>, greater<pair<size_t, int>>> queue;
+        for (size_t s = 0; s < frequencies.size(); s++) {
+          if (frequencies[s] > 0) {
+            leaf[s] = (int) parent.size();
+            queue.push({frequencies[s], leaf[s]});
+            parent.push_back(-1);
+          }
+        }
+        while (queue.size() > 1) {
+          pair<size_t, int> a = queue.top();
+          queue.pop();
+          pair<size_t, int> b = queue.top();
+          queue.pop();
+          int node = (int) parent.size();
+          parent.push_back(-1);
+          parent[a.second] = node;
+          parent[b.second] = node;
+          queue.push({a.first + b.first, node});
+        }
+
+        unsigned longest = 0;
+        for (size_t s = 0; s < frequencies.size(); s++) {
+          unsigned depth = 0;
+          for (int n = leaf[s]; n >= 0 && parent[n] >= 0; n = parent[n]) {
+            depth++;
+          }
+          lengths[s] = (unsigned char) depth;
+          longest = max(longest, depth);
+        }
+        if (longest <= maxBits) {
+          return lengths;
+        }
+        for (size_t & f : frequencies) {
+          if (f > 0) {
+            f = (f + 1) / 2;
+          }
+        }
+      }
+    }
+
+    /**
+     * Canonical codes for the given code lengths, bit-reversed so that they
+     * can be sent least significant bit first.
+     */
+    vector<unsigned> canonicalCodes(vector<unsigned char> const & lengths) {
+      unsigned count[16] = {0};
+      for (unsigned char length : lengths) {
+        count[length]++;
+      }
+      count[0] = 0;
+      unsigned next[16] = {0};
+      unsigned code = 0;
+      for (unsigned bits = 1; bits < 16; bits++) {
+        code = (code + count[bits - 1]) << 1;
+        next[bits] = code;
+      }
+
+      vector<unsigned> codes(lengths.size(), 0);
+      for (size_t s = 0; s < lengths.size(); s++) {
+        unsigned length = lengths[s];
+        if (length == 0) { continue; }
+        unsigned value = next[length]++;
+        unsigned reversed = 0;
+        for (unsigned i = 0; i < length; i++) {
+          reversed = (reversed << 1) | ((value >> i) & 1);
+        }
+        codes[s] = reversed;
+      }
+      return codes;
+    }
+
+    /**
+     * Continues an adler32 checksum (start with 1) over data, as used in
+     * the zlib trailer.
+     */
+    unsigned updateAdler32(unsigned adler, unsigned char const * data, size_t length) {
+      unsigned s1 = adler & 0xffff;
+      unsigned s2 = adler >> 16;
+      while (length > 0) {
+        // 5552 bytes is the most that can be summed before s2 overflows
+        size_t amount = min(length, (size_t) 5552);
+        length -= amount;
+        for (size_t i = 0; i < amount; i++) {
+          s1 += data[i];
+          s2 += s1;
+        }
+        data += amount;
+        s1 %= 65521;
+        s2 %= 65521;
+      }
+      return (s2 << 16) | s1;
+    }
+
+    void write32(unsigned char * out, unsigned value) {
+      out[0] = (unsigned char) (value >> 24);
+      out[1] = (unsigned char) (value >> 16);
+      out[2] = (unsigned char) (value >> 8);
+      out[3] = (unsigned char) value;
+    }
+
+    unsigned char paeth(short a, short b, short c) {
+      short pa = abs(b - c);
+      short pb = abs(a - c);
+      short pc = abs(a + b - c - c);
+      if (pc < pa && pc < pb) { return (unsigned char) c; }
+      if (pb < pa) { return (unsigned char) b; }
+      return (unsigned char) a;
+    }
+
+    /**
+     * Applies PNG filter type to one row, as lodepng's filterScanline does.
+     * prev is nullptr for the first row.
+     */
+    void filterRow(unsigned char * out, unsigned char const * row, unsigned char const * prev,
+                   size_t length, size_t bpp, unsigned char type) {
+      for (size_t i = 0; i < length; i++) {
+        unsigned char left = i >= bpp ? row[i - bpp] : 0;
+        unsigned char up = prev ? prev[i] : 0;
+        unsigned char upLeft = (prev && i >= bpp) ? prev[i - bpp] : 0;
+        switch (type) {
+          case 0: out[i] = row[i]; break;
+          case 1: out[i] = row[i] - left; break;
+          case 2: out[i] = row[i] - up; break;
+          case 3: out[i] = row[i] - ((left + up) >> 1); break;
+          default: out[i] = row[i] - paeth(left, up, upLeft); break;
+        }
+      }
+    }
+  }
+
+  /**
+   * DeflateStream: raw deflate data produced a piece at a time. Each piece
+   * is coded as one dynamic Huffman block whose matches may reach up to one
+   * window back into earlier pieces, so only that much input is kept.
+   */
+  class DeflateStream {
+  public:
+    DeflateStream();
+
+    /**
+      * Compresses the next piece of input and appends every completed byte
+      * of deflate data to out. Pass final with the last piece, which may be
+      * empty, to end the data; its last byte is then padded and appended.
+      */
+    void write(unsigned char const * in, size_t size, bool final, vector<unsigned char> & out);
+
+  private:
+    vector<unsigned char> window_;   /*< Up to one window of earlier input, then the current piece */
+    size_t base_;                    /*< Stream position of window_[0] */
+    vector<size_t> head_;            /*< Latest stream position of each hash, or NONE */
+    vector<size_t> chain_;           /*< Previous position with the same hash, by position modulo the window */
+    vector<pair<unsigned short, unsigned short>> symbols_; /*< Literal (distance 0) or length and distance */
+    uint64_t bits_;                  /*< Bits not yet appended, least significant first */
+    unsigned bitCount_;              /*< Number of bits in bits_ */
+
+    size_t hashAt(size_t pos) const;
+    void insert(size_t pos, size_t end);
+    void findMatch(size_t pos, size_t end, size_t & length, size_t & distance) const;
+    void writeBlock(bool final, vector<unsigned char> & out);
+    void putBits(unsigned value, unsigned count, vector<unsigned char> & out);
+  };
+
+  DeflateStream::DeflateStream()
+      : base_(0), head_(HASH_SIZE, NONE), chain_(WINDOW_SIZE, NONE), bits_(0), bitCount_(0) {
+  }
+
+  void DeflateStream::write(unsigned char const * in, size_t size, bool final, vector<unsigned char> & out) {
+    // keep one window of history in front of the new piece
+    if (window_.size() > WINDOW_SIZE) {
+      size_t drop = window_.size() - WINDOW_SIZE;
+      window_.erase(window_.begin(), window_.begin() + drop);
+      base_ += drop;
+    }
+    size_t start = window_.size();
+    window_.insert(window_.end(), in, in + size);
+    size_t end = window_.size();
+
+    // greedy matching with one step of lazy evaluation, as in zlib
+    symbols_.clear();
+    size_t length = 0;
+    size_t distance = 0;
+    bool found = false;
+    for (size_t i = start; i < end; ) {
+      if (!found) {
+        findMatch(i, end, length, distance);
+      }
+      found = false;
+      insert(i, end);
+
+      if (length >= MIN_MATCH && length < NICE_MATCH && i + 1 < end) {
+        size_t nextLength;
+        size_t nextDistance;
+        findMatch(i + 1, end, nextLength, nextDistance);
+        if (nextLength > length) {
+          symbols_.push_back({window_[i], 0});
+          i++;
+          length = nextLength;
+          distance = nextDistance;
+          found = true;
+          continue;
+        }
+      }
+
+      if (length >= MIN_MATCH) {
+        symbols_.push_back({(unsigned short) length, (unsigned short) distance});
+        for (size_t k = 1; k < length; k++) {
+          insert(i + k, end);
+        }
+        i += length;
+      } else {
+        symbols_.push_back({window_[i], 0});
+        i++;
+      }
+    }
+
+    if (size > 0 || final) {
+      writeBlock(final, out);
+    }
+  }
+
+  size_t DeflateStream::hashAt(size_t pos) const {
+    return ((window_[pos] << 10) ^ (window_[pos + 1] << 5) ^ window_[pos + 2]) & (HASH_SIZE - 1);
+  }
+
+  void DeflateStream::insert(size_t pos, size_t end) {
+    if (pos + MIN_MATCH > end) { return; }
+    size_t h = hashAt(pos);
+    chain_[(base_ + pos) & (WINDOW_SIZE - 1)] = head_[h];
+    head_[h] = base_ + pos;
+  }
+
+  void DeflateStream::findMatch(size_t pos, size_t end, size_t & length, size_t & distance) const {
+    length = 0;
+    distance = 0;
+    if (pos + MIN_MATCH > end) { return; }
+
+    size_t limit = min(end - pos, MAX_MATCH);
+    size_t here = base_ + pos;
+    unsigned char const * target = &window_[pos];
+    size_t candidate = head_[hashAt(pos)];
+    for (unsigned tries = 0; tries < MAX_CHAIN && candidate != NONE; tries++) {
+      if (candidate < base_ || candidate >= here || here - candidate > WINDOW_SIZE) { break; }
+      unsigned char const * earlier = &window_[candidate - base_];
+      if (earlier[length] == target[length]) {
+        size_t n = 0;
+        while (n < limit && earlier[n] == target[n]) { n++; }
+        if (n > length) {
+          length = n;
+          distance = here - candidate;
+          if (n >= NICE_MATCH || n == limit) { break; }
+        }
+      }
+      // a slot reused by a later position ends the chain
+      size_t next = chain_[candidate & (WINDOW_SIZE - 1)];
+      if (next == NONE || next >= candidate) { break; }
+      candidate = next;
+    }
+    if (length < MIN_MATCH) {
+      length = 0;
+    }
+  }
+
+  void DeflateStream::writeBlock(bool final, vector<unsigned char> & out) {
+    vector<size_t> literalFrequencies(286, 0);
+    vector<size_t> distanceFrequencies(30, 0);
+    for (pair<unsigned short, unsigned short> const & symbol : symbols_) {
+      if (symbol.second == 0) {
+        literalFrequencies[symbol.first]++;
+      } else {
+        literalFrequencies[257 + lengthCode(symbol.first)]++;
+        distanceFrequencies[distanceCode(symbol.second)]++;
+      }
+    }
+    literalFrequencies[256]++; // end of block
+
+    vector<unsigned char> literalLengths = codeLengths(literalFrequencies, 15);
+    vector<unsigned char> distanceLengths = codeLengths(distanceFrequencies, 15);
+    vector<unsigned> literalCodes = canonicalCodes(literalLengths);
+    vector<unsigned> distanceCodes = canonicalCodes(distanceLengths);
+
+    size_t literalCount = 286;
+    while (literalCount > 257 && literalLengths[literalCount - 1] == 0) { literalCount--; }
+    size_t distanceCount = 30;
+    while (distanceCount > 1 && distanceLengths[distanceCount - 1] == 0) { distanceCount--; }
+
+    // run-length code both sets of lengths with symbols 16, 17 and 18
+    vector<unsigned char> all(literalLengths.begin(), literalLengths.begin() + literalCount);
+    all.insert(all.end(), distanceLengths.begin(), distanceLengths.begin() + distanceCount);
+    vector<pair<unsigned char, unsigned char>> runs;
+    for (size_t i = 0; i < all.size(); ) {
+      size_t run = 1;
+      while (i + run < all.size() && all[i + run] == all[i]) { run++; }
+      if (all[i] == 0 && run >= 3) {
+        size_t n = min(run, (size_t) 138);
+        runs.push_back(n >= 11 ? make_pair((unsigned char) 18, (unsigned char) (n - 11))
+                               : make_pair((unsigned char) 17, (unsigned char) (n - 3)));
+        i += n;
+      } else if (all[i] != 0 && run >= 4) {
+        size_t n = min(run - 1, (size_t) 6);
+        runs.push_back({all[i], 0});
+        runs.push_back({16, (unsigned char) (n - 3)});
+        i += 1 + n;
+      } else {
+        runs.push_back({all[i], 0});
+        i++;
+      }
+    }
+
+    vector<size_t> runFrequencies(19, 0);
+    for (pair<unsigned char, unsigned char> const & run : runs) {
+      runFrequencies[run.first]++;
+    }
+    vector<unsigned char> runLengths = codeLengths(runFrequencies, 7);
+    vector<unsigned> runCodes = canonicalCodes(runLengths);
+    size_t runCount = 19;
+    while (runCount > 4 && runLengths[CODE_LENGTH_ORDER[runCount - 1]] == 0) { runCount--; }
+
+    // block header: final flag, dynamic Huffman type, then the code lengths
+    putBits(final ? 1 : 0, 1, out);
+    putBits(2, 2, out);
+    putBits((unsigned) (literalCount - 257), 5, out);
+    putBits((unsigned) (distanceCount - 1), 5, out);
+    putBits((unsigned) (runCount - 4), 4, out);
+    for (size_t i = 0; i < runCount; i++) {
+      putBits(runLengths[CODE_LENGTH_ORDER[i]], 3, out);
+    }
+    static unsigned const RUN_EXTRA[3] = {2, 3, 7};
+    for (pair<unsigned char, unsigned char> const & run : runs) {
+      putBits(runCodes[run.first], runLengths[run.first], out);
+      if (run.first >= 16) {
+        putBits(run.second, RUN_EXTRA[run.first - 16], out);
+      }
+    }
+
+    for (pair<unsigned short, unsigned short> const & symbol : symbols_) {
+      if (symbol.second == 0) {
+        putBits(literalCodes[symbol.first], literalLengths[symbol.first], out);
+        continue;
+      }
+      unsigned code = lengthCode(symbol.first);
+      putBits(literalCodes[257 + code], literalLengths[257 + code], out);
+      putBits(symbol.first - LENGTH_BASE[code], LENGTH_EXTRA[code], out);
+      code = distanceCode(symbol.second);
+      putBits(distanceCodes[code], distanceLengths[code], out);
+      putBits(symbol.second - DISTANCE_BASE[code], DISTANCE_EXTRA[code], out);
+    }
+    putBits(literalCodes[256], literalLengths[256], out);
+
+    // the final block pads its last byte; otherwise it waits for the next block
+    if (final && bitCount_ > 0) {
+      out.push_back((unsigned char) bits_);
+      bits_ = 0;
+      bitCount_ = 0;
+    }
+  }
+
+  void DeflateStream::putBits(unsigned value, unsigned count, vector<unsigned char> & out) {
+    bits_ |= (uint64_t) value << bitCount_;
+    bitCount_ += count;
+    while (bitCount_ >= 8) {
+      out.push_back((unsigned char) bits_);
+      bits_ >>= 8;
+      bitCount_ -= 8;
+    }
+  }
+
+  PNGStreamWriter::PNGStreamWriter(unsigned int width, unsigned int height, bool alpha, PNGSink sink)
+      : width_(width), height_(height), rowsWritten_(0), bytesPerPixel_(alpha ? 4 : 3), sink_(sink),
+        error_(0), headerPending_(true), adler_(1), deflater_(NULL) {
+    if (width_ == 0 || height_ == 0) {
+      fail(93); // zero width or height
+      return;
+    }
+
+    size_t rowBytes = width_ * bytesPerPixel_;
+    row_.resize(rowBytes);
+    previous_.resize(rowBytes);
+    attempt_.resize(rowBytes);
+    pending_.reserve(ROW_GROUP_BYTES + rowBytes + 1);
+    deflater_ = new DeflateStream();
+
+    static unsigned char const signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+    if (!sink_(signature, sizeof(signature))) {
+      fail(SINK_REFUSED);
+      return;
+    }
+
+    unsigned char header[13];
+    write32(header, width_);
+    write32(header + 4, height_);
+    header[8] = 8;                 // bit depth
+    header[9] = alpha ? 6 : 2;     // colour type: RGBA or RGB
+    header[10] = 0;                // deflate
+    header[11] = 0;                // adaptive filtering
+    header[12] = 0;                // no interlace
+    emitChunk("IHDR", header, sizeof(header));
+  }
+
+  PNGStreamWriter::~PNGStreamWriter() {
+    delete deflater_;
+  }
+
+  bool PNGStreamWriter::writeRow(unsigned char const * rgba) {
+    if (error_) { return false; }
+    if (rowsWritten_ == height_) { return fail(91); } // more rows than the header promised
+
+    size_t rowBytes = row_.size();
+    if (bytesPerPixel_ == 4) {
+      memcpy(row_.data(), rgba, rowBytes);
+    } else {
+      for (unsigned x = 0; x < width_; x++) {
+        row_[3 * x] = rgba[4 * x];
+        row_[3 * x + 1] = rgba[4 * x + 1];
+        row_[3 * x + 2] = rgba[4 * x + 2];
+      }
+    }
+
+    // lodepng's minimum-sum heuristic: keep the filter whose bytes,
+    // read as signed differences, sum to the least
+    unsigned char const * prev = rowsWritten_ > 0 ? previous_.data() : NULL;
+    unsigned char bestType = 0;
+    size_t smallest = 0;
+    size_t start = pending_.size();
+    pending_.resize(start + 1 + rowBytes);
+    for (unsigned char type = 0; type < 5; type++) {
+      filterRow(attempt_.data(), row_.data(), prev, rowBytes, bytesPerPixel_, type);
+      size_t sum = 0;
+      for (size_t i = 0; i < rowBytes; i++) {
+        unsigned char s = attempt_[i];
+        sum += type == 0 ? s : (s < 128 ? s : 255U - s);
+      }
+      if (type == 0 || sum < smallest) {
+        bestType = type;
+        smallest = sum;
+        memcpy(&pending_[start + 1], attempt_.data(), rowBytes);
+      }
+    }
+    pending_[start] = bestType;
+
+    row_.swap(previous_);
+    rowsWritten_++;
+
+    if (pending_.size() >= ROW_GROUP_BYTES) {
+      return flush(false);
+    }
+    return true;
+  }
+
+  bool PNGStreamWriter::finish() {
+    if (error_) { return false; }
+    if (rowsWritten_ != height_) { return fail(91); } // fewer rows than the header promised
+    if (!flush(true)) { return false; }
+    return emitChunk("IEND", NULL, 0);
+  }
+
+  unsigned PNGStreamWriter::error() const {
+    return error_;
+  }
+
+  bool PNGStreamWriter::flush(bool final) {
+    adler_ = updateAdler32(adler_, pending_.data(), pending_.size());
+
+    // zlib stream: header, deflate data, then the adler32 of the filtered rows
+    chunk_.assign(8, 0);
+    if (headerPending_) {
+      chunk_.push_back(120); // deflate with a 32K window
+      chunk_.push_back(1);   // no preset dictionary
+      headerPending_ = false;
+    }
+    deflater_->write(pending_.data(), pending_.size(), final, chunk_);
+    pending_.clear();
+    if (final) {
+      unsigned char trailer[4];
+      write32(trailer, adler_);
+      chunk_.insert(chunk_.end(), trailer, trailer + 4);
+    }
+    if (chunk_.size() == 8) { return true; }
+    return sendChunk("IDAT");
+  }
+
+  bool PNGStreamWriter::emitChunk(char const * type, unsigned char const * data, size_t size) {
+    chunk_.assign(8, 0);
+    chunk_.insert(chunk_.end(), data, data + size);
+    return sendChunk(type);
+  }
+
+  bool PNGStreamWriter::sendChunk(char const * type) {
+    if (error_) { return false; }
+
+    // length, type, data, then the crc of type and data
+    write32(chunk_.data(), (unsigned) (chunk_.size() - 8));
+    memcpy(&chunk_[4], type, 4);
+    chunk_.resize(chunk_.size() + 4);
+    lodepng_chunk_generate_crc(chunk_.data());
+
+    if (!sink_(chunk_.data(), chunk_.size())) {
+      return fail(SINK_REFUSED);
+    }
+    return true;
+  }
+
+  bool PNGStreamWriter::fail(unsigned error) {
+    if (!error_) { error_ = error; }
+    return false;
+  }
+}
@@ -0,0 +1,118 @@
+/**
+ * @file PNGStreamWriter.h
+ * A PNG encoder that takes an image one row at a time and hands the
+ * encoded file to a sink as it goes.
+ */
+
+#ifndef CS221_PNGSTREAMWRITER_H_
+#define CS221_PNGSTREAMWRITER_H_
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+namespace cs221util {
+  class DeflateStream;
+
+  /**
+   * Receives consecutive pieces of an encoded PNG file. Returns false to
+   * abort the encode, e.g. when a write fails.
+   */
+  typedef function<bool(unsigned char const * data, size_t size)> PNGSink;
+
+  /**
+   * PNGStreamWriter: encodes 8-bit RGB or RGBA PNGs without holding the
+   * image. Each row is filtered as it arrives (with lodepng's minimum-sum
+   * heuristic), each row group is deflated as one dynamic Huffman block
+   * matched against the previous 32K of filtered data, and the compressed
+   * data goes to the sink as IDAT chunks. Memory is a few rows plus the
+   * deflate window and one row group, however large the image.
+   */
+  class PNGStreamWriter {
+  public:
+    /**
+      * Starts a PNG and writes its signature and header to sink.
+      * @param width Width of the image.
+      * @param height Height of the image.
+      * @param alpha Whether to store an alpha channel; if not, rows are
+      *              still given as RGBA and alpha is dropped.
+      * @param sink Destination of the encoded bytes.
+      */
+    PNGStreamWriter(unsigned int width, unsigned int height, bool alpha, PNGSink sink);
+
+    ~PNGStreamWriter();
+
+    /**
+      * Encodes the next row of the image.
+      * @param rgba width pixels of four bytes each, in red, green, blue,
+      *             alpha order.
+      * @return false if the encode has failed, now or earlier.
+      */
+    bool writeRow(unsigned char const * rgba);
+
+    /**
+      * Flushes the remaining data and ends the file.
+      * @pre every row has been written.
+      * @return true, if the whole file was encoded and accepted by the sink.
+      */
+    bool finish();
+
+    /**
+      * Error code of a sink that refused data. It is outside lodepng's
+      * range of error codes.
+      */
+    static const unsigned SINK_REFUSED = 1000;
+
+    /**
+      * Gets the error code of a failed encode, or 0 if none: SINK_REFUSED
+      * if the sink refused data, otherwise a lodepng error code. The wrong
+      * number of rows gives error 91, an invalid data size.
+      */
+    unsigned error() const;
+
+  private:
+    unsigned int width_;          /*< Width of the image */
+    unsigned int height_;         /*< Height of the image */
+    unsigned int rowsWritten_;    /*< Rows received so far */
+    size_t bytesPerPixel_;        /*< 3 for RGB, 4 for RGBA */
+    PNGSink sink_;                /*< Destination of the encoded bytes */
+    unsigned error_;              /*< First error, or 0 */
+    bool headerPending_;          /*< Whether the zlib header is still to be sent */
+    unsigned adler_;              /*< Checksum of the filtered data so far */
+    DeflateStream * deflater_;        /*< Deflates the filtered rows */
+    vector<unsigned char> row_;       /*< Current row in the output colour type */
+    vector<unsigned char> previous_;  /*< Previous row in the output colour type */
+    vector<unsigned char> attempt_;   /*< Scratch for one filter attempt */
+    vector<unsigned char> pending_;   /*< Filtered rows not yet deflated */
+    vector<unsigned char> chunk_;     /*< Chunk being built: length and type, then data */
+
+    PNGStreamWriter(PNGStreamWriter const & other);             // not copyable
+    PNGStreamWriter & operator=(PNGStreamWriter const & other); // not assignable
+
+    /**
+      * Deflates the pending rows and sends whatever compressed data is
+      * complete as an IDAT chunk.
+      */
+    bool flush(bool final);
+
+    /**
+      * Sends one chunk of the given type and data to the sink.
+      */
+    bool emitChunk(char const * type, unsigned char const * data, size_t size);
+
+    /**
+      * Completes the chunk in chunk_, whose data follows eight reserved
+      * bytes, and sends it to the sink.
+      */
+    bool sendChunk(char const * type);
+
+    /**
+      * Records the first error and returns false.
+      */
+    bool fail(unsigned error);
+  };
+}
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file PackedPNG.cpp
+ * Implementation of a PNG image stored as packed RGBA8 pixels.
+ */
+
+#include <iostream>
+#include <string>
+#include <cassert>
+#include "lodepng/lodepng.h"
+#include "PackedPNG.h"
+#include "MappedFile.h"
+
+namespace cs221util {
+  PackedPNG::PackedPNG() {
+    width_ = 0;
+    height_ = 0;
+  }
+
+  PackedPNG::PackedPNG(unsigned int width, unsigned int height) {
+    width_ = width;
+    height_ = height;
+    bytes_.resize((size_t) width * height * 4, 0);
+    for (size_t i = 3; i < bytes_.size(); i += 4) {
+      bytes_[i] = 255;
+    }
+  }
+
+  PackedPNG::PackedPNG(PNG const & other) {
+    width_ = other.width();
+    height_ = other.height();
+    bytes_.resize((size_t) width_ * height_ * 4);
+    RGBA8Pixel * packed = reinterpret_cast<RGBA8Pixel *>(bytes_.data());
+    for (unsigned y = 0; y < height_; y++) {
+      RGBAPixel const * source = other.row(y);
+      for (unsigned x = 0; x < width_; x++) {
+        *packed++ = RGBA8Pixel::fromRGBAPixel(source[x]);
+      }
+    }
+  }
+
+  PNG PackedPNG::toPNG() const {
+    PNG unpacked(width_, height_);
+    RGBA8Pixel const * packed = reinterpret_cast<RGBA8Pixel const *>(bytes_.data());
+    for (unsigned y = 0; y < height_; y++) {
+      RGBAPixel * target = unpacked.row(y);
+      for (unsigned x = 0; x < width_; x++) {
+        target[x] = (packed++)->toRGBAPixel();
+      }
+    }
+    return unpacked;
+  }
+
+  bool PackedPNG::operator==(PackedPNG const & other) const {
+    return width_ == other.width_ && height_ == other.height_ && bytes_ == other.bytes_;
+  }
+
+  bool PackedPNG::operator!=(PackedPNG const & other) const {
+    return !(*this == other);
+  }
+
+  bool PackedPNG::readFromFile(string const & fileName) {
+    vector<unsigned char> decoded;
+    unsigned width;
+    unsigned height;
+    unsigned error;
+    {
+      MappedFile file(fileName);
+      error = file.error();
+      if (!error) {
+        error = lodepng::decode(decoded, width, height, file.data(), file.size());
+      }
+    }
+
+    if (error) {
+      cerr << "PNG decoder error " << error << ": " << lodepng_error_text(error) << endl;
+      return false;
+    }
+
+    width_ = width;
+    height_ = height;
+    bytes_.swap(decoded);
+    return true;
+  }
+
+  bool PackedPNG::writeToFile(string const & fileName) const {
+    unsigned error = lodepng::encode(fileName, bytes_, width_, height_);
+    if (error) {
+      cerr << "PNG encoding error " << error << ": " << lodepng_error_text(error) << endl;
+    }
+    return (error == 0);
+  }
+
+  RGBA8Pixel * PackedPNG::getPixel(unsigned int x, unsigned int y) {
+    return const_cast<RGBA8Pixel *>(static_cast<PackedPNG const &>(*this).getPixel(x, y));
+  }
+
+  RGBA8Pixel const * PackedPNG::getPixel(unsigned int x, unsigned int y) const {
+    if (width_ == 0 || height_ == 0) {
+      cerr << "ERROR: Call to cs221util::PackedPNG::getPixel() made on an image with no pixels." << endl;
+      assert(width_ > 0);
+      assert(height_ > 0);
+    }
+
+    if (x >= width_) {
+      cerr << "WARNING: Call to cs221util::PackedPNG::getPixel(" << x << "," << y << ") tries to access x=" << x
+          << ", which is outside of the image (image width: " << width_ << ")." << endl;
+      cerr << "       : Truncating x to " << (width_ - 1) << endl;
+      x = width_ - 1;
+    }
+
+    if (y >= height_) {
+      cerr << "WARNING: Call to cs221util::PackedPNG::getPixel(" << x << "," << y << ") tries to access y=" << y
+          << ", which is outside of the image (image height: " << height_ << ")." << endl;
+      cerr << "       : Truncating y to " << (height_ - 1) << endl;
+      y = height_ - 1;
+    }
+
+    return reinterpret_cast<RGBA8Pixel const *>(&bytes_[((size_t) y * width_ + x) * 4]);
+  }
+
+  unsigned int PackedPNG::width() const {
+    return width_;
+  }
+
+  unsigned int PackedPNG::height() const {
+    return height_;
+  }
+
+  unsigned char * PackedPNG::data() {
+    return bytes_.data();
+  }
+
+  unsigned char const * PackedPNG::data() const {
+    return bytes_.data();
+  }
+}
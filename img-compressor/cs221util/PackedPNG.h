@@ -0,0 +1,134 @@
+/**
+ * @file PackedPNG.h
+ * A PNG image stored as packed RGBA8 pixels, four bytes each.
+ */
+
+#ifndef CS221_PACKEDPNG_H_
+#define CS221_PACKEDPNG_H_
+
+#include <string>
+#include <vector>
+#include "PNG.h"
+#include "RGBA8Pixel.h"
+
+using namespace std;
+
+namespace cs221util {
+  /**
+   * PackedPNG: the same image as PNG in a quarter of the memory. Pixels
+   * are kept in lodepng's own row-major RGBA8 layout, so reading and
+   * writing files hand the buffer to lodepng without any per-pixel
+   * conversion. Conversion to and from PNG happens only when asked for.
+   */
+  class PackedPNG {
+  public:
+    /**
+      * Creates an empty image.
+      */
+    PackedPNG();
+
+    /**
+      * Creates an image of the specified dimensions, filled with
+      * opaque black.
+      * @param width Width of the new image.
+      * @param height Height of the new image.
+      */
+    PackedPNG(unsigned int width, unsigned int height);
+
+    /**
+      * Packs a PNG, converting alpha the way PNG::writeToFile does, so
+      * both write the same file.
+      * @param other PNG to be packed.
+      */
+    explicit PackedPNG(PNG const & other);
+
+    /**
+      * Unpacks this image into a PNG, converting alpha the way
+      * PNG::readFromFile does.
+      * @return The unpacked image.
+      */
+    PNG toPNG() const;
+
+    /**
+      * Equality operator: checks if two images have exactly the same
+      * dimensions and bytes.
+      * @param other Image to be checked.
+      * @return Whether the current image is equal to the other image.
+      */
+    bool operator== (PackedPNG const & other) const;
+
+    /**
+      * Inequality operator: checks if two images are different.
+      * @param other Image to be checked.
+      * @return Whether the current image differs from the other image.
+      */
+    bool operator!= (PackedPNG const & other) const;
+
+    /**
+      * Reads in a PNG image from a file. lodepng decodes to RGBA8, which
+      * becomes the pixel buffer as it is, with no per-pixel conversion.
+      * Overwrites any current image content.
+      * @param fileName Name of the file to be read from.
+      * @return true, if the image was successfully read and loaded.
+      */
+    bool readFromFile(string const & fileName);
+
+    /**
+      * Writes the image to a file, encoding straight from the pixel
+      * buffer.
+      * @param fileName Name of the file to be written.
+      * @return true, if the image was successfully written.
+      */
+    bool writeToFile(string const & fileName) const;
+
+    /**
+      * Pixel access operator. Gets a pointer to the pixel at the given
+      * coordinates in the image. (0,0) is the upper left corner.
+      * Out-of-range coordinates are truncated, as in PNG::getPixel.
+      * @param x X-coordinate for the pixel pointer to be grabbed from.
+      * @param y Y-coordinate for the pixel pointer to be grabbed from.
+      * @return A pointer to the pixel at the given coordinates.
+      */
+    RGBA8Pixel * getPixel(unsigned int x, unsigned int y);
+    RGBA8Pixel const * getPixel(unsigned int x, unsigned int y) const;
+
+    /**
+      * Unchecked pixel access, as PNG::pixelAt: no bounds checks,
+      * warnings or clamping.
+      * @param x X-coordinate for the pixel pointer to be grabbed from.
+      * @param y Y-coordinate for the pixel pointer to be grabbed from.
+      * @return A pointer to the pixel at the given coordinates.
+      * @pre x < width() and y < height().
+      */
+    RGBA8Pixel const * pixelAt(unsigned int x, unsigned int y) const {
+      return reinterpret_cast<RGBA8Pixel const *>(bytes_.data()) + (size_t) y * width_ + x;
+    }
+
+    /**
+      * Gets the width of this image.
+      * @return Width of the image.
+      */
+    unsigned int width() const;
+
+    /**
+      * Gets the height of this image.
+      * @return Height of the image.
+      */
+    unsigned int height() const;
+
+    /**
+      * Gets the raw pixel bytes: height rows of width RGBA8 pixels, with
+      * no padding between rows.
+      * @return A pointer to the first byte of the top row.
+      */
+    unsigned char * data();
+    unsigned char const * data() const;
+
+  private:
+    unsigned int width_;          /*< Width of the image */
+    unsigned int height_;         /*< Height of the image */
+    vector<unsigned char> bytes_; /*< RGBA8 pixels, row-major */
+  };
+}
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file RGBA8Pixel.h
+ * A packed four-byte pixel, laid out exactly as lodepng's RGBA8 buffers.
+ */
+
+#ifndef CS221_RGBA8PIXEL_H_
+#define CS221_RGBA8PIXEL_H_
+
+#include "RGBAPixel.h"
+
+namespace cs221util {
+  /**
+   * RGBA8Pixel: red, green, blue and alpha as one byte each, with alpha
+   * in [0, 255] rather than RGBAPixel's double in [0, 1]. Four bytes per
+   * pixel instead of sixteen, and trivially copyable, so whole rows can
+   * be moved with memcpy.
+   */
+  struct RGBA8Pixel {
+    unsigned char r; /**< red component of pixel, [0,255] */
+    unsigned char g; /**< green component of pixel, [0,255] */
+    unsigned char b; /**< blue component of pixel, [0,255] */
+    unsigned char a; /**< alpha component of pixel, [0,255] */
+
+    /**
+     * Converts to an RGBAPixel, scaling alpha to [0, 1] exactly as
+     * PNG::readFromFile does.
+     */
+    RGBAPixel toRGBAPixel() const {
+      return RGBAPixel(r, g, b, a / 255.);
+    }
+
+    /**
+     * Converts from an RGBAPixel, scaling alpha to [0, 255] exactly as
+     * PNG::writeToFile does.
+     */
+    static RGBA8Pixel fromRGBAPixel(RGBAPixel const & pixel) {
+      RGBA8Pixel packed;
+      packed.r = pixel.r;
+      packed.g = pixel.g;
+      packed.b = pixel.b;
+      packed.a = pixel.a * 255;
+      return packed;
+    }
+
+    bool operator== (RGBA8Pixel const & other) const {
+      return r == other.r && g == other.g && b == other.b && a == other.a;
+    }
+
+    bool operator!= (RGBA8Pixel const & other) const {
+      return !(*this == other);
+    }
+  };
+
+  static_assert(sizeof(RGBA8Pixel) == 4, "RGBA8Pixel must match lodepng's RGBA8 layout");
+}
+
+#endif
@@ -19,13 +19,6 @@ namespace cs221util {
     a = 1.0;
   }
 
-  RGBAPixel::RGBAPixel(const RGBAPixel& other) {
-      r = other.r;
-      g = other.g;
-      b = other.b;
-      a = other.a;
-  }
-
   RGBAPixel::RGBAPixel(int red, int green, int blue){
     r = red;
     g = green;
@@ -39,14 +32,6 @@ namespace cs221util {
     a = alpha;
   }
 
-  RGBAPixel & RGBAPixel::operator=(RGBAPixel const & other) {
-    this->r = other.r;
-    this->g = other.g;
-    this->b = other.b;
-    this->a = other.a;
-    return *this;
-  }
-
   bool RGBAPixel::operator== (RGBAPixel const & other) const {
     // thank/blame Wade for the following function
     // adapted by cinda to allow for slight deviations in RGB
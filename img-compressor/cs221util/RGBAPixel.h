@@ -10,6 +10,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <type_traits>
 
 namespace cs221util {
   class RGBAPixel {
@@ -29,9 +30,10 @@ namespace cs221util {
     RGBAPixel();
 
     /**
-     * Constructs a RGBAPixel as a copy of another.
+     * Constructs a RGBAPixel as a copy of another. Copies are plain field
+     * copies, so the type is trivially copyable.
      */
-    RGBAPixel(const RGBAPixel& other);
+    RGBAPixel(const RGBAPixel& other) = default;
 
     /**
      * Constructs an opaque RGBAPixel with the given red, green,
@@ -54,7 +56,7 @@ namespace cs221util {
      */
     RGBAPixel(int red, int green, int blue, double alpha);
 
-    RGBAPixel & operator=(RGBAPixel const & other);
+    RGBAPixel & operator=(RGBAPixel const & other) = default;
     bool operator== (RGBAPixel const & other) const ;
     bool operator!= (RGBAPixel const & other) const ;
     bool operator<  (RGBAPixel const & other) const ;
@@ -76,6 +78,8 @@ namespace cs221util {
    */
   std::ostream & operator<<(std::ostream & out, RGBAPixel const & pixel);
   std::stringstream & operator<<(std::stringstream & out, RGBAPixel const & pixel);
+
+  static_assert(std::is_trivially_copyable<RGBAPixel>::value, "pixel arrays are copied as blocks of bytes");
 }
 
 #endif
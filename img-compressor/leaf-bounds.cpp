@@ -0,0 +1,72 @@
+/**
+ * @file leaf-bounds.cpp
+ * @description per-subtree ranges of leaf colours
+ */
+
+#include <algorithm>
+#include "leaf-bounds.h"
+
+using namespace std;
+
+/**
+ * Bounds of a subtree that is the single leaf of the given colour.
+ */
+LeafBounds LeafBoundsOf(const RGBAPixel& leaf) {
+	// same arithmetic as RGBAPixel::distanceTo
+	double values[4] = {(leaf.r / 255.0) * leaf.a, (leaf.g / 255.0) * leaf.a,
+		(leaf.b / 255.0) * leaf.a, leaf.a};
+	LeafBounds b;
+	for (int c = 0; c < 4; c++) {
+		b.low[c] = values[c];
+		b.high[c] = values[c];
+	}
+	return b;
+}
+
+/**
+ * Widens into to also cover the leaves of other.
+ */
+void IncludeBounds(LeafBounds& into, const LeafBounds& other) {
+	for (int c = 0; c < 4; c++) {
+		into.low[c] = min(into.low[c], other.low[c]);
+		into.high[c] = max(into.high[c], other.high[c]);
+	}
+}
+
+/**
+ * A value no larger than avg.distanceTo(leaf) for the farthest leaf in
+ * bounds: the leaves attaining the smallest and largest value of each
+ * channel are at least as far away as that channel's difference alone.
+ */
+double LeafDistanceFloor(const LeafBounds& bounds, RGBAPixel avg) {
+	double self[3] = {(avg.r / 255.0) * avg.a, (avg.g / 255.0) * avg.a, (avg.b / 255.0) * avg.a};
+
+	double lower = 0;
+	for (int c = 0; c < 3; c++) {
+		double low_diff = bounds.low[c] - self[c];
+		double high_diff = bounds.high[c] - self[c];
+		lower = max(lower, max(low_diff * low_diff, high_diff * high_diff));
+	}
+	return lower;
+}
+
+/**
+ * A value no smaller than avg.distanceTo(leaf) for any leaf in bounds:
+ * the distance to the farthest point of the bounding box, padded for
+ * rounding.
+ */
+double LeafDistanceCeiling(const LeafBounds& bounds, RGBAPixel avg) {
+	double self[3] = {(avg.r / 255.0) * avg.a, (avg.g / 255.0) * avg.a, (avg.b / 255.0) * avg.a};
+
+	double upper = 0;
+	for (int c = 0; c < 3; c++) {
+		double low_diff = bounds.low[c] - self[c];
+		double high_diff = bounds.high[c] - self[c];
+		double diff = max(low_diff * low_diff, high_diff * high_diff);
+
+		double low_shifted = low_diff - (bounds.high[3] - avg.a);
+		double high_shifted = high_diff - (bounds.low[3] - avg.a);
+		upper += max(diff, max(low_shifted * low_shifted, high_shifted * high_shifted));
+	}
+	return upper + upper * 1e-9 + 1e-12;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file leaf-bounds.h
+ * @description per-subtree ranges of leaf colours, used to decide pruning
+ *              without walking the leaves
+ */
+
+#ifndef _LEAF_BOUNDS_H_
+#define _LEAF_BOUNDS_H_
+
+#include "cs221util/RGBAPixel.h"
+
+using namespace cs221util;
+
+/**
+ * Range of the premultiplied red, green and blue values and of the alpha
+ * of every leaf in a subtree, as computed by RGBAPixel::distanceTo.
+ */
+struct LeafBounds {
+    double low[4];
+    double high[4];
+};
+
+/**
+ * Bounds of a subtree that is the single leaf of the given colour.
+ */
+LeafBounds LeafBoundsOf(const RGBAPixel& leaf);
+
+/**
+ * Widens into to also cover the leaves of other.
+ */
+void IncludeBounds(LeafBounds& into, const LeafBounds& other);
+
+/**
+ * A value no larger than avg.distanceTo(leaf) for the farthest leaf in
+ * bounds: the leaves attaining the smallest and largest value of each
+ * channel are at least as far away as that channel's difference alone.
+ */
+double LeafDistanceFloor(const LeafBounds& bounds, RGBAPixel avg);
+
+/**
+ * A value no smaller than avg.distanceTo(leaf) for any leaf in bounds:
+ * the distance to the farthest point of the bounding box, padded for
+ * rounding.
+ */
+double LeafDistanceCeiling(const LeafBounds& bounds, RGBAPixel avg);
+
+#endif
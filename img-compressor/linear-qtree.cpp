@@ -0,0 +1,286 @@
+/**
+ * @file linear-qtree.cpp
+ * @description implementation of LinearQTree class, a pointer-free quadtree
+ */
+
+#include "linear-qtree.h"
+#include "average-kernel.h"
+#include "quadrants.h"
+#include <cmath>
+
+/**
+ * Builds a LinearQTree out of the given PNG, with the same split rule
+ * and the same constant-time average colours as QTree(const PNG&).
+ */
+LinearQTree::LinearQTree(const PNG& imIn) {
+	height = imIn.height();
+	width = imIn.width();
+	if (width == 0 || height == 0) {
+		return;
+	}
+	pair<unsigned int, unsigned int> ul = {0,0};
+	pair<unsigned int, unsigned int> lr = {width-1, height-1};
+	Build(imIn, ul, lr);
+	colors.shrink_to_fit();
+	children.shrink_to_fit();
+}
+
+/**
+ * Render returns a PNG image consisting of the pixels stored in the
+ * tree, drawing every leaf's rectangle with its colour.
+ * @param scale multiplier for each horizontal/vertical dimension
+ * @pre scale > 0
+ */
+PNG LinearQTree::Render(unsigned int scale) const {
+	PNG rendered = PNG(width*scale, height*scale);
+	if (!colors.empty()) {
+		Render(scale, rendered, 0, {0,0}, {width-1, height-1});
+	}
+	return rendered;
+}
+
+/**
+ * Prunes every subtree, as high in the tree as possible, whose leaves
+ * are all within tolerance of the subtree root's colour. The tree is
+ * pruned in place; beyond it, only one LeafBounds per level of the
+ * tree is kept while the subtrees to collapse are found.
+ * @param tolerance maximum RGBA distance to qualify for pruning
+ * @pre this tree has not previously been pruned.
+ */
+void LinearQTree::Prune(double tolerance) {
+	if (colors.empty()) {
+		return;
+	}
+	LeafBounds bounds;
+	MarkCollapsed(0, tolerance, bounds);
+
+	size_t out = 0;
+	Compact(0, out);
+	colors.resize(out);
+	children.resize(out);
+	colors.shrink_to_fit();
+	children.shrink_to_fit();
+}
+
+/**
+ * Counts the number of nodes in the tree
+ */
+unsigned int LinearQTree::CountNodes() const {
+	return colors.size();
+}
+
+/**
+ * Counts the number of leaves in the tree
+ */
+unsigned int LinearQTree::CountLeaves() const {
+	unsigned int leaves = 0;
+	for (size_t i = 0; i < children.size(); i++) {
+		if (children[i] == 0) {
+			leaves++;
+		}
+	}
+	return leaves;
+}
+
+/**
+ * Number of bytes used to store the nodes of the tree.
+ */
+size_t LinearQTree::MemoryUsage() const {
+	return colors.capacity() * sizeof(Color) + children.capacity() * sizeof(unsigned char);
+}
+
+/**
+ * Appends the subtree for the rectangle ul..lr in preorder and
+ * returns the colour of its root. Uses the split rule and the
+ * weighted average of QTree::BuildNode, so both trees hold the
+ * same colours.
+ */
+RGBAPixel LinearQTree::Build(const PNG& img, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) {
+	size_t index = colors.size();
+	colors.push_back(Color());
+	children.push_back(0);
+
+	if (ul == lr) {
+		RGBAPixel pixel = *img.pixelAt(ul.first, ul.second);
+		colors[index] = ToColor(pixel);
+		return pixel;
+	}
+
+	Quadrants q = SplitQuadrants(ul, lr);
+	RGBAPixel avgs[4];
+	const RGBAPixel* present[4];
+	int area[4];
+	unsigned char mask = 0;
+	for (int k = 0; k < 4; k++) {
+		present[k] = nullptr;
+		area[k] = 0;
+		if (q.present[k]) {
+			avgs[k] = Build(img, q.ul[k], q.lr[k]);
+			present[k] = &avgs[k];
+			area[k] = q.Area(k);
+			mask |= ChildBit(k);
+		}
+	}
+
+	RGBAPixel result = WeightedAverage(present, area);
+	colors[index] = ToColor(result);
+	children[index] = mask;
+	return result;
+}
+
+/**
+ * Paints the leaves of the subtree starting at index i, whose root
+ * covers ul..lr. Returns the index just past the subtree.
+ */
+size_t LinearQTree::Render(unsigned int scale, PNG& img, size_t i, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const {
+	unsigned char mask = children[i];
+
+	if (mask == 0) {
+		img.fill(ul.first * scale, ul.second * scale, (lr.first + 1 - ul.first) * scale,
+			(lr.second + 1 - ul.second) * scale, ToPixel(colors[i]));
+		return i + 1;
+	}
+
+	Quadrants q = SplitQuadrants(ul, lr);
+	i++;
+	for (int k = 0; k < 4; k++) {
+		if (mask & ChildBit(k)) {
+			i = Render(scale, img, i, q.ul[k], q.lr[k]);
+		}
+	}
+	return i;
+}
+
+/**
+ * Sets COLLAPSE_BIT on every internal node of the subtree starting at
+ * index i whose leaves are all within tolerance of its colour, in one
+ * post-order pass. Fills in bounds with the subtree's leaf bounds and
+ * returns the index just past the subtree. The bounds of each child
+ * live only on the stack, while its parent is being decided.
+ */
+size_t LinearQTree::MarkCollapsed(size_t i, double tolerance, LeafBounds& bounds) {
+	unsigned char mask = children[i];
+	if (mask == 0) {
+		bounds = LeafBoundsOf(ToPixel(colors[i]));
+		return i + 1;
+	}
+
+	size_t child = i + 1;
+	for (int k = 0; k < 4; k++) {
+		if (!(mask & ChildBit(k))) {
+			continue;
+		}
+		LeafBounds childBounds;
+		size_t next = MarkCollapsed(child, tolerance, childBounds);
+		if (child == i + 1) {
+			bounds = childBounds;
+		} else {
+			IncludeBounds(bounds, childBounds);
+		}
+		child = next;
+	}
+
+	if (WithinTolerance(i, child, tolerance, bounds)) {
+		children[i] |= COLLAPSE_BIT;
+	}
+	return child;
+}
+
+/**
+ * Moves the subtree starting at index i down to index out, in place,
+ * dropping everything below the highest marked nodes. Nodes are read in
+ * preorder and out never passes i, so no node is overwritten before it
+ * is read. Advances out past the moved nodes and returns the index just
+ * past the subtree.
+ * @pre out <= i
+ */
+size_t LinearQTree::Compact(size_t i, size_t& out) {
+	unsigned char mask = children[i];
+	colors[out] = colors[i];
+	if (mask == 0 || (mask & COLLAPSE_BIT)) {
+		size_t end = SubtreeEnd(i);
+		children[out++] = 0;
+		return end;
+	}
+
+	children[out++] = mask;
+	size_t child = i + 1;
+	for (int k = 0; k < ChildCount(mask); k++) {
+		child = Compact(child, out);
+	}
+	return child;
+}
+
+/**
+ * Index just past the subtree starting at index i, found by walking
+ * the child masks: each node adds its children to the count of nodes
+ * still to be passed.
+ */
+size_t LinearQTree::SubtreeEnd(size_t i) const {
+	size_t pending = 1;
+	while (pending > 0) {
+		pending += ChildCount(children[i]) - 1;
+		i++;
+	}
+	return i;
+}
+
+/**
+ * Decides whether every leaf of the subtree from index i to end is
+ * within tolerance of the subtree root's colour, as QTree does: from
+ * the leaf bounds when they settle it, otherwise by checking the leaves.
+ */
+bool LinearQTree::WithinTolerance(size_t i, size_t end, double tolerance, const LeafBounds& bounds) const {
+	RGBAPixel avg = ToPixel(colors[i]);
+	if (LeafDistanceFloor(bounds, avg) > tolerance) {
+		return false;
+	}
+	if (LeafDistanceCeiling(bounds, avg) <= tolerance) {
+		return true;
+	}
+	for (size_t j = i; j < end; j++) {
+		if ((children[j] & CHILD_BITS) == 0 && avg.distanceTo(ToPixel(colors[j])) > tolerance) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Bit of the child mask for child k (0 = NW, 1 = NE, 2 = SW, 3 = SE).
+ */
+unsigned char LinearQTree::ChildBit(int k) {
+	return (unsigned char) (NW_BIT << k);
+}
+
+/**
+ * Number of children in a child mask.
+ */
+int LinearQTree::ChildCount(unsigned char mask) {
+	int count = 0;
+	for (int k = 0; k < 4; k++) {
+		if (mask & ChildBit(k)) {
+			count++;
+		}
+	}
+	return count;
+}
+
+/**
+ * Converts a packed colour back to an RGBAPixel.
+ */
+RGBAPixel LinearQTree::ToPixel(Color c) {
+	return RGBAPixel(c.r, c.g, c.b, c.a / 255.);
+}
+
+/**
+ * Packs an RGBAPixel, rounding alpha to the nearest byte.
+ */
+LinearQTree::Color LinearQTree::ToColor(const RGBAPixel& p) {
+	Color c;
+	c.r = p.r;
+	c.g = p.g;
+	c.b = p.b;
+	c.a = (unsigned char) lround(p.a * 255);
+	return c;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file linear-qtree.h
+ * @description declaration of LinearQTree class, a pointer-free quadtree
+ *              stored as a flat array of node colours
+ */
+
+#ifndef _LINEAR_QTREE_H_
+#define _LINEAR_QTREE_H_
+
+#include <utility>
+#include <vector>
+#include "cs221util/PNG.h"
+#include "cs221util/RGBAPixel.h"
+#include "leaf-bounds.h"
+
+using namespace std;
+using namespace cs221util;
+
+/**
+ * LinearQTree: the same decomposition as QTree, without the Node objects.
+ *
+ * Nodes are stored in preorder (NW, NE, SW, SE), which for a quadtree is
+ * the Z-order (Morton order) of its regions. Each node keeps only its
+ * colour and a bitmask of which children are present; the children of a
+ * node follow it immediately in the array. Node rectangles are never
+ * stored: they are rederived during traversal from the image bounds and
+ * the split rule used by QTree's constructor.
+ *
+ * Render, Prune, CountNodes and CountLeaves give the same results as the
+ * QTree functions of the same names on a tree built from the same image.
+ * Alpha is held as a byte, which is exact for images read from PNG files.
+ */
+class LinearQTree {
+public:
+    /**
+     * Builds a LinearQTree out of the given PNG, with the same split rule
+     * and the same constant-time average colours as QTree(const PNG&).
+     */
+    LinearQTree(const PNG& imIn);
+
+    /**
+     * Render returns a PNG image consisting of the pixels stored in the
+     * tree, drawing every leaf's rectangle with its colour.
+     * @param scale multiplier for each horizontal/vertical dimension
+     * @pre scale > 0
+     */
+    PNG Render(unsigned int scale) const;
+
+    /**
+     * Prunes every subtree, as high in the tree as possible, whose leaves
+     * are all within tolerance of the subtree root's colour. The tree is
+     * pruned in place; beyond it, only one LeafBounds per level of the
+     * tree is kept while the subtrees to collapse are found.
+     * @param tolerance maximum RGBA distance to qualify for pruning
+     * @pre this tree has not previously been pruned.
+     */
+    void Prune(double tolerance);
+
+    /**
+     * Counts the number of nodes in the tree
+     */
+    unsigned int CountNodes() const;
+
+    /**
+     * Counts the number of leaves in the tree
+     */
+    unsigned int CountLeaves() const;
+
+    /**
+     * Number of bytes used to store the nodes of the tree.
+     */
+    size_t MemoryUsage() const;
+
+private:
+    /**
+     * Packed node colour; alpha is stored as a byte in [0, 255].
+     */
+    struct Color {
+        unsigned char r;
+        unsigned char g;
+        unsigned char b;
+        unsigned char a;
+    };
+
+    static const unsigned char NW_BIT = 1; // node has a NW child
+    static const unsigned char NE_BIT = 2; // node has a NE child
+    static const unsigned char SW_BIT = 4; // node has a SW child
+    static const unsigned char SE_BIT = 8; // node has a SE child
+    static const unsigned char CHILD_BITS = 15; // all of the above
+    static const unsigned char COLLAPSE_BIT = 16; // set by Prune on nodes it will collapse
+
+    vector<Color> colors;           // node colours in preorder
+    vector<unsigned char> children; // child bitmask of each node, parallel to colors
+
+    unsigned int height; // height of PNG represented by the tree
+    unsigned int width;  // width of PNG represented by the tree
+
+    /**
+     * Appends the subtree for the rectangle ul..lr in preorder and
+     * returns the colour of its root.
+     */
+    RGBAPixel Build(const PNG& img, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr);
+
+    /**
+     * Paints the leaves of the subtree starting at index i, whose root
+     * covers ul..lr. Returns the index just past the subtree.
+     */
+    size_t Render(unsigned int scale, PNG& img, size_t i, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const;
+
+    /**
+     * Sets COLLAPSE_BIT on every internal node of the subtree starting at
+     * index i whose leaves are all within tolerance of its colour, in one
+     * post-order pass. Fills in bounds with the subtree's leaf bounds and
+     * returns the index just past the subtree.
+     */
+    size_t MarkCollapsed(size_t i, double tolerance, LeafBounds& bounds);
+
+    /**
+     * Moves the subtree starting at index i down to index out, in place,
+     * dropping everything below the highest marked nodes. Advances out
+     * past the moved nodes and returns the index just past the subtree.
+     * @pre out <= i
+     */
+    size_t Compact(size_t i, size_t& out);
+
+    /**
+     * Index just past the subtree starting at index i, found by walking
+     * the child masks.
+     */
+    size_t SubtreeEnd(size_t i) const;
+
+    /**
+     * Whether every leaf of the subtree from index i to end is within
+     * tolerance of the subtree root's colour.
+     */
+    bool WithinTolerance(size_t i, size_t end, double tolerance, const LeafBounds& bounds) const;
+
+    /**
+     * Number of children in a child mask.
+     */
+    static int ChildCount(unsigned char mask);
+
+    /**
+     * Bit of the child mask for child k (0 = NW, 1 = NE, 2 = SW, 3 = SE).
+     */
+    static unsigned char ChildBit(int k);
+
+    /**
+     * Converts between the packed colour and RGBAPixel.
+     */
+    static RGBAPixel ToPixel(Color c);
+    static Color ToColor(const RGBAPixel& p);
+};
+
+#endif
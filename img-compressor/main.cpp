@@ -1,302 +1,1077 @@
-/**
- * @file main.cpp
- * @description basic test cases for QTree
- *              CPSC 221 PA3
- * 
- *              You may add your own tests to this file
- *
- *              THIS FILE WILL NOT BE SUBMITTED
- */
-
-#include <limits.h>
-#include <sys/stat.h>
-#include <vector>
-
-#include "cs221util/RGBAPixel.h"
-#include "cs221util/PNG.h"
-#include "cs221util/catch.hpp"
-
-#include <iostream>
-#include <string>
-
-#include "qtree.h"
-
-using namespace std;
-
-/**********************************/
-/*** TEST FUNCTION DECLARATIONS ***/
-/**********************************/
-void TestBuildRender(unsigned int scale);
-void TestFlipHorizontal();
-void TestRotateCCW();
-void TestPrune(double tol);
-
-/***********************************/
-/*** MAIN FUNCTION PROGRAM ENTRY ***/
-/***********************************/
-
-int main(int argc, char* argv[]) {
-
-	TestBuildRender(1);
-	TestBuildRender(6);
-	TestFlipHorizontal();
-	TestRotateCCW();
-	TestPrune(0.01);
-	TestPrune(0.05);
-
-	return 0;
-}
-
-/*************************************/
-/*** TEST FUNCTION IMPLEMENTATIONS ***/
-/*************************************/
-
-void TestBuildRender(unsigned int scale) {
-	cout << "Entered TestBuildRender, scale: " << scale << endl;
-
-	// read input PNG
-	PNG input;
-	input.readFromFile("images-original/malachi-60x87.png");
-
-	cout << "Constructing QTree from image... ";
-	QTree t(input);
-	cout << "done." << endl;
-
-	cout << "Rendering tree to PNG at x" << scale << " scale... ";
-	PNG output = t.Render(scale);
-	cout << "done." << endl;
-
-
-	// write output PNG
-	string outfilename = "images-output/malachi-render_x" + to_string(scale) + ".png";
-	cout << "Writing rendered PNG to file... ";
-	output.writeToFile(outfilename);
-	cout << "done." << endl;
-
-	cout << "Exiting TestBuildRender.\n" << endl;
-
-	// PNG solnx;
-    // solnx.readFromFile("images-soln/soln-malachi-render_x" + to_string(scale) + ".png");
-    // REQUIRE( solnx == output );
-}
-
-void TestFlipHorizontal() {
-
-	
-	cout << "Entered TestFlipHorizontal" << endl;
-
-	// read input PNG
-	PNG input;
-	input.readFromFile("images-original/malachi-60x87.png");
-
-	cout << "Constructing QTree from image... ";
-	QTree t(input);
-	cout << "done." << endl;
-
-	cout << "Calling FlipHorizontal... ";
-	t.FlipHorizontal();
-	cout << "done." << endl;
-
-	cout << "Rendering tree to PNG at x1 scale... ";
-	PNG output = t.Render(1);
-	cout << "done." << endl;
-
-	// write output PNG
-	string outfilename = "images-output/malachi-fliphorizontal_x1-render_x1.png";
-	cout << "Writing rendered PNG to file... ";
-	output.writeToFile(outfilename);
-	cout << "done." << endl;
-
-	cout << "Calling FlipHorizontal a second time... ";
-	t.FlipHorizontal();
-	cout << "done." << endl;
-
-	cout << "Rendering tree to PNG at x1 scale... ";
-	output = t.Render(1);
-	cout << "done." << endl;
-
-	// write output PNG
-	outfilename = "images-output/malachi-fliphorizontal_x2-render_x1.png";
-	cout << "Writing rendered PNG to file... ";
-	output.writeToFile(outfilename);
-	cout << "done." << endl;
-
-	cout << "Exiting TestFlipHorizontal.\n" << endl;
-}
-
-void TestRotateCCW() {
-	cout << "Entered TestRotateCCW" << endl;
-	// read input PNG
-	PNG pixel;
-	pixel.readFromFile("images-original/5x7pixel.png");
-
-	cout << "Constructing QTree from image... ";
-	QTree q(pixel);
-	cout << "done." << endl;
-
-	cout << "Calling RotateCCW on small image... ";
-	q.RotateCCW();
-	cout << "done." << endl;
-
-	cout << "Rendering tree to PNG at x1 scale... ";
-	PNG r_pixel = q.Render(1);
-	cout << "done." << endl;
-
-	
-	cout << "Writing rendered PNG to file... ";
-	r_pixel.writeToFile("images-output/5x7pixel-result.png");
-	cout << "done." << endl;
-	
-	cout << "Calling RotateCCW on small image again... ";
-	q.RotateCCW();
-	cout << "done." << endl;
-
-	cout << "Rendering tree to PNG at x1 scale... ";
-	PNG m_pixel = q.Render(1);
-	cout << "done." << endl;
-
-	
-	cout << "Writing rendered PNG to file... ";
-	m_pixel.writeToFile("images-output/5x7pixel-result-twice.png");
-	cout << "done." << endl;
-
-
-
-
-
-	cout << "Entered TestRotateCCW" << endl;
-	// read input PNG
-	PNG pixel2;
-	pixel2.readFromFile("images-original/7x5pixel.png");
-
-	cout << "Constructing QTree from image... ";
-	QTree g(pixel2);
-	cout << "done." << endl;
-
-	cout << "Calling RotateCCW on small image... ";
-	g.RotateCCW();
-	cout << "done." << endl;
-
-	cout << "Rendering tree to PNG at x1 scale... ";
-	PNG r_pixel2 = g.Render(1);
-	cout << "done." << endl;
-
-	
-	cout << "Writing rendered PNG to file... ";
-	r_pixel2.writeToFile("images-output/7x5pixel-result.png");
-	cout << "done." << endl;
-	
-	cout << "Calling RotateCCW on small image again... ";
-	g.RotateCCW();
-	cout << "done." << endl;
-
-	cout << "Rendering tree to PNG at x1 scale... ";
-	PNG m_pixel2 = g.Render(1);
-	cout << "done." << endl;
-
-	
-	cout << "Writing rendered PNG to file... ";
-	m_pixel2.writeToFile("images-output/7x5pixel-result-twice.png");
-	cout << "done." << endl;
-
-
-
-
-	// read input PNG
-	PNG input;
-	input.readFromFile("images-original/malachi-60x87.png");
-
-	cout << "Constructing QTree from image... ";
-	QTree t(input);
-	cout << "done." << endl;
-
-	cout << "Calling RotateCCW... ";
-	t.RotateCCW();
-	cout << "done." << endl;
-
-	cout << "Rendering tree to PNG at x1 scale... ";
-	PNG output = t.Render(1);
-	cout << "done." << endl;
-
-	// write output PNG
-	string outfilename = "images-output/malachi-rotateccw_x1-render_x1.png";
-	cout << "Writing rendered PNG to file... ";
-	output.writeToFile(outfilename);
-	cout << "done." << endl;
-
-	cout << "Calling RotateCCW a second time... ";
-	t.RotateCCW();
-	cout << "done." << endl;
-
-	cout << "Rendering tree to PNG at x1 scale... ";
-	output = t.Render(1);
-	cout << "done." << endl;
-
-	// write output PNG
-	outfilename = "images-output/malachi-rotateccw_x2-render_x1.png";
-	cout << "Writing rendered PNG to file... ";
-	output.writeToFile(outfilename);
-	cout << "done." << endl;
-
-	cout << "Calling RotateCCW a third time... ";
-	t.RotateCCW();
-	cout << "done." << endl;
-
-	cout << "Rendering tree to PNG at x1 scale... ";
-	output = t.Render(1);
-	cout << "done." << endl;
-
-	// write output PNG
-	outfilename = "images-output/malachi-rotateccw_x3-render_x1.png";
-	cout << "Writing rendered PNG to file... ";
-	output.writeToFile(outfilename);
-	cout << "done." << endl;
-
-	cout << "Calling RotateCCW a fourth time... ";
-	t.RotateCCW();
-	cout << "done." << endl;
-
-	cout << "Rendering tree to PNG at x1 scale... ";
-	output = t.Render(1);
-	cout << "done." << endl;
-
-	// write output PNG
-	outfilename = "images-output/malachi-rotateccw_x4-render_x1.png";
-	cout << "Writing rendered PNG to file... ";
-	output.writeToFile(outfilename);
-	cout << "done." << endl;
-
-	cout << "Exiting TestRotateCCW.\n" << endl;
-}
-
-void TestPrune(double tol) {
-	cout << "Entered TestPrune, tolerance: " << tol << endl;
-
-	// read input PNG
-	PNG input;
-	input.readFromFile("images-original/kkkk_nnkm-256x224.png");
-
-	cout << "Constructing QTree from image... ";
-	QTree t(input);
-	cout << "done." << endl;
-
-	cout << "Tree contains " << t.CountNodes() << " nodes and " << t.CountLeaves() << " leaves." << endl;
-
-	cout << "Calling Prune... ";
-	t.Prune(tol);
-	cout << "done." << endl;
-
-	cout << "Pruned tree contains " << t.CountNodes() << " nodes and " << t.CountLeaves() << " leaves." << endl;
-	
-	cout << "Rendering tree to PNG at x1 scale... ";
-	PNG output = t.Render(1);
-	cout << "done." << endl;
-
-	// write output PNG
-	string outfilename = "images-output/kkkk_nnkm-256x224-prune_" + to_string(tol) + "-render_x1.png";
-	cout << "Writing rendered PNG to file... ";
-	output.writeToFile(outfilename);
-	cout << "done." << endl;
-
-	cout << "Exiting TestPrune.\n" << endl;
-}
\ No newline at end of file
+/**
+ * @file main.cpp
+ * @description basic test cases for QTree
+ *              CPSC 221 PA3
+ * 
+ *              You may add your own tests to this file
+ *
+ *              THIS FILE WILL NOT BE SUBMITTED
+ */
+
+#include <limits.h>
+#include <sys/stat.h>
+#include <vector>
+
+#include "cs221util/RGBAPixel.h"
+#include "cs221util/PNG.h"
+#include "cs221util/PackedPNG.h"
+#include "cs221util/MappedFile.h"
+#include "cs221util/PNGStreamWriter.h"
+#include "cs221util/lodepng/lodepng.h"
+#include "cs221util/catch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "qtree.h"
+#include "linear-qtree.h"
+#include "qtree-cache.h"
+
+using namespace std;
+
+/**********************************/
+/*** TEST FUNCTION DECLARATIONS ***/
+/**********************************/
+void TestBuildRender(unsigned int scale);
+void TestFlipHorizontal();
+void TestRotateCCW();
+void TestPrune(double tol);
+void TestCopy();
+void TestLinearQTree(double tol);
+void TestParallelBuild(unsigned int cutoff);
+void TestBottomUpBuild();
+void TestExactAverages(double maxVariance);
+void TestParallelPrune(double tol, unsigned int cutoff);
+void TestPruneToLeafCount(unsigned int leaves);
+void TestRenderAtTolerance(unsigned int scale);
+void TestParallelRender(unsigned int scale, unsigned int cutoff);
+void TestViewportRender(unsigned int scale);
+void TestLevelOfDetail(unsigned int scale);
+void TestRenderResized(unsigned int w, unsigned int h);
+void TestRenderInto(unsigned int scale);
+void TestMoveAndSwap();
+void TestPackedPNG();
+void TestStreamingWrite(unsigned int scale);
+void TestDeflateEdgeCases();
+void TestMappedFile();
+void TestMemoryRoundTrip(double tolerance);
+void TestQTreeCache(double tolerance);
+void TestCompareModes();
+
+/************************************/
+/*** TEST HELPER DECLARATIONS ***/
+/************************************/
+PNG ReadOriginal(const string& name);
+const char* Verdict(bool passed, const char* yes, const char* no);
+bool StreamRoundTrip(const vector<unsigned char>& rgba, unsigned int w, unsigned int h, bool alpha, size_t& bytes);
+
+int failures = 0; // checks that have failed so far
+
+/***********************************/
+/*** MAIN FUNCTION PROGRAM ENTRY ***/
+/***********************************/
+
+int main(int argc, char* argv[]) {
+
+	TestBuildRender(1);
+	TestBuildRender(6);
+	TestFlipHorizontal();
+	TestRotateCCW();
+	TestPrune(0.01);
+	TestPrune(0.05);
+	TestCopy();
+	TestLinearQTree(0.05);
+	TestParallelBuild(256);
+	TestBottomUpBuild();
+	TestExactAverages(100);
+	TestParallelPrune(0.01, 1024);
+	TestPruneToLeafCount(1000);
+	TestRenderAtTolerance(2);
+	TestParallelRender(6, 65536);
+	TestViewportRender(3);
+	TestLevelOfDetail(2);
+	TestRenderResized(64, 56);
+	TestRenderInto(2);
+	TestMoveAndSwap();
+	TestPackedPNG();
+	TestStreamingWrite(6);
+	TestDeflateEdgeCases();
+	TestMappedFile();
+	TestMemoryRoundTrip(0.01);
+	TestQTreeCache(0.01);
+	TestCompareModes();
+
+	if (failures == 0) {
+		cout << "All checks passed." << endl;
+		return 0;
+	}
+	cout << failures << " checks FAILED." << endl;
+	return 1;
+}
+
+/*************************************/
+/*** TEST HELPER IMPLEMENTATIONS ***/
+/*************************************/
+
+/**
+ * Reads an input image from images-original.
+ */
+PNG ReadOriginal(const string& name) {
+	PNG img;
+	img.readFromFile("images-original/" + name);
+	return img;
+}
+
+/**
+ * Records the outcome of a check, counting it if it failed, and returns
+ * the word to print for it.
+ */
+const char* Verdict(bool passed, const char* yes, const char* no) {
+	if (!passed) {
+		failures++;
+	}
+	return passed ? yes : no;
+}
+
+/**
+ * Encodes w x h RGBA bytes a row at a time with PNGStreamWriter, storing
+ * alpha or not, and decodes the result with lodepng. Returns whether the
+ * decoded pixels match; bytes is set to the encoded size.
+ */
+bool StreamRoundTrip(const vector<unsigned char>& rgba, unsigned int w, unsigned int h, bool alpha, size_t& bytes) {
+	vector<unsigned char> encoded;
+	PNGStreamWriter writer(w, h, alpha, [&encoded](unsigned char const* data, size_t size) {
+		encoded.insert(encoded.end(), data, data + size);
+		return true;
+	});
+	for (unsigned int y = 0; y < h; y++) {
+		writer.writeRow(&rgba[(size_t) y * w * 4]);
+	}
+	bool written = writer.finish();
+	bytes = encoded.size();
+
+	vector<unsigned char> decoded;
+	unsigned int dw = 0;
+	unsigned int dh = 0;
+	unsigned int error = lodepng::decode(decoded, dw, dh, encoded);
+	return written && error == 0 && dw == w && dh == h && decoded == rgba;
+}
+
+/*************************************/
+/*** TEST FUNCTION IMPLEMENTATIONS ***/
+/*************************************/
+
+void TestBuildRender(unsigned int scale) {
+	cout << "Entered TestBuildRender, scale: " << scale << endl;
+
+	// read input PNG
+	PNG input;
+	input.readFromFile("images-original/malachi-60x87.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree t(input);
+	cout << "done." << endl;
+
+	cout << "Rendering tree to PNG at x" << scale << " scale... ";
+	PNG output = t.Render(scale);
+	cout << "done." << endl;
+
+
+	// write output PNG
+	string outfilename = "images-output/malachi-render_x" + to_string(scale) + ".png";
+	cout << "Writing rendered PNG to file... ";
+	output.writeToFile(outfilename);
+	cout << "done." << endl;
+
+	cout << "Exiting TestBuildRender.\n" << endl;
+
+	// PNG solnx;
+    // solnx.readFromFile("images-soln/soln-malachi-render_x" + to_string(scale) + ".png");
+    // REQUIRE( solnx == output );
+}
+
+void TestFlipHorizontal() {
+
+	
+	cout << "Entered TestFlipHorizontal" << endl;
+
+	// read input PNG
+	PNG input;
+	input.readFromFile("images-original/malachi-60x87.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree t(input);
+	cout << "done." << endl;
+
+	cout << "Calling FlipHorizontal... ";
+	t.FlipHorizontal();
+	cout << "done." << endl;
+
+	cout << "Rendering tree to PNG at x1 scale... ";
+	PNG output = t.Render(1);
+	cout << "done." << endl;
+
+	// write output PNG
+	string outfilename = "images-output/malachi-fliphorizontal_x1-render_x1.png";
+	cout << "Writing rendered PNG to file... ";
+	output.writeToFile(outfilename);
+	cout << "done." << endl;
+
+	cout << "Calling FlipHorizontal a second time... ";
+	t.FlipHorizontal();
+	cout << "done." << endl;
+
+	cout << "Rendering tree to PNG at x1 scale... ";
+	output = t.Render(1);
+	cout << "done." << endl;
+
+	// write output PNG
+	outfilename = "images-output/malachi-fliphorizontal_x2-render_x1.png";
+	cout << "Writing rendered PNG to file... ";
+	output.writeToFile(outfilename);
+	cout << "done." << endl;
+
+	cout << "Exiting TestFlipHorizontal.\n" << endl;
+}
+
+void TestRotateCCW() {
+	cout << "Entered TestRotateCCW" << endl;
+	// read input PNG
+	PNG pixel;
+	pixel.readFromFile("images-original/5x7pixel.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree q(pixel);
+	cout << "done." << endl;
+
+	cout << "Calling RotateCCW on small image... ";
+	q.RotateCCW();
+	cout << "done." << endl;
+
+	cout << "Rendering tree to PNG at x1 scale... ";
+	PNG r_pixel = q.Render(1);
+	cout << "done." << endl;
+
+	
+	cout << "Writing rendered PNG to file... ";
+	r_pixel.writeToFile("images-output/5x7pixel-result.png");
+	cout << "done." << endl;
+	
+	cout << "Calling RotateCCW on small image again... ";
+	q.RotateCCW();
+	cout << "done." << endl;
+
+	cout << "Rendering tree to PNG at x1 scale... ";
+	PNG m_pixel = q.Render(1);
+	cout << "done." << endl;
+
+	
+	cout << "Writing rendered PNG to file... ";
+	m_pixel.writeToFile("images-output/5x7pixel-result-twice.png");
+	cout << "done." << endl;
+
+
+
+
+
+	cout << "Entered TestRotateCCW" << endl;
+	// read input PNG
+	PNG pixel2;
+	pixel2.readFromFile("images-original/7x5pixel.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree g(pixel2);
+	cout << "done." << endl;
+
+	cout << "Calling RotateCCW on small image... ";
+	g.RotateCCW();
+	cout << "done." << endl;
+
+	cout << "Rendering tree to PNG at x1 scale... ";
+	PNG r_pixel2 = g.Render(1);
+	cout << "done." << endl;
+
+	
+	cout << "Writing rendered PNG to file... ";
+	r_pixel2.writeToFile("images-output/7x5pixel-result.png");
+	cout << "done." << endl;
+	
+	cout << "Calling RotateCCW on small image again... ";
+	g.RotateCCW();
+	cout << "done." << endl;
+
+	cout << "Rendering tree to PNG at x1 scale... ";
+	PNG m_pixel2 = g.Render(1);
+	cout << "done." << endl;
+
+	
+	cout << "Writing rendered PNG to file... ";
+	m_pixel2.writeToFile("images-output/7x5pixel-result-twice.png");
+	cout << "done." << endl;
+
+
+
+
+	// read input PNG
+	PNG input;
+	input.readFromFile("images-original/malachi-60x87.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree t(input);
+	cout << "done." << endl;
+
+	cout << "Calling RotateCCW... ";
+	t.RotateCCW();
+	cout << "done." << endl;
+
+	cout << "Rendering tree to PNG at x1 scale... ";
+	PNG output = t.Render(1);
+	cout << "done." << endl;
+
+	// write output PNG
+	string outfilename = "images-output/malachi-rotateccw_x1-render_x1.png";
+	cout << "Writing rendered PNG to file... ";
+	output.writeToFile(outfilename);
+	cout << "done." << endl;
+
+	cout << "Calling RotateCCW a second time... ";
+	t.RotateCCW();
+	cout << "done." << endl;
+
+	cout << "Rendering tree to PNG at x1 scale... ";
+	output = t.Render(1);
+	cout << "done." << endl;
+
+	// write output PNG
+	outfilename = "images-output/malachi-rotateccw_x2-render_x1.png";
+	cout << "Writing rendered PNG to file... ";
+	output.writeToFile(outfilename);
+	cout << "done." << endl;
+
+	cout << "Calling RotateCCW a third time... ";
+	t.RotateCCW();
+	cout << "done." << endl;
+
+	cout << "Rendering tree to PNG at x1 scale... ";
+	output = t.Render(1);
+	cout << "done." << endl;
+
+	// write output PNG
+	outfilename = "images-output/malachi-rotateccw_x3-render_x1.png";
+	cout << "Writing rendered PNG to file... ";
+	output.writeToFile(outfilename);
+	cout << "done." << endl;
+
+	cout << "Calling RotateCCW a fourth time... ";
+	t.RotateCCW();
+	cout << "done." << endl;
+
+	cout << "Rendering tree to PNG at x1 scale... ";
+	output = t.Render(1);
+	cout << "done." << endl;
+
+	// write output PNG
+	outfilename = "images-output/malachi-rotateccw_x4-render_x1.png";
+	cout << "Writing rendered PNG to file... ";
+	output.writeToFile(outfilename);
+	cout << "done." << endl;
+
+	cout << "Exiting TestRotateCCW.\n" << endl;
+}
+
+void TestPrune(double tol) {
+	cout << "Entered TestPrune, tolerance: " << tol << endl;
+
+	// read input PNG
+	PNG input;
+	input.readFromFile("images-original/kkkk_nnkm-256x224.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree t(input);
+	cout << "done." << endl;
+
+	cout << "Tree contains " << t.CountNodes() << " nodes and " << t.CountLeaves() << " leaves." << endl;
+
+	cout << "Calling Prune... ";
+	t.Prune(tol);
+	cout << "done." << endl;
+
+	cout << "Pruned tree contains " << t.CountNodes() << " nodes and " << t.CountLeaves() << " leaves." << endl;
+	
+	cout << "Rendering tree to PNG at x1 scale... ";
+	PNG output = t.Render(1);
+	cout << "done." << endl;
+
+	// write output PNG
+	string outfilename = "images-output/kkkk_nnkm-256x224-prune_" + to_string(tol) + "-render_x1.png";
+	cout << "Writing rendered PNG to file... ";
+	output.writeToFile(outfilename);
+	cout << "done." << endl;
+
+	cout << "Exiting TestPrune.\n" << endl;
+}
+
+void TestCopy() {
+	cout << "Entered TestCopy" << endl;
+
+	PNG input = ReadOriginal("malachi-60x87.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree t(input);
+	cout << "done." << endl;
+
+	cout << "Copy constructing and assigning QTree... ";
+	QTree copied(t);
+	QTree assigned(input);
+	assigned.Prune(0.05);
+	assigned = t;
+	cout << "done." << endl;
+
+	PNG soln;
+	soln.readFromFile("images-soln/soln-malachi-render_x1.png");
+	cout << "Copied tree render " << Verdict(copied.Render(1) == soln, "matches", "DOES NOT match") << " solution." << endl;
+	cout << "Assigned tree render " << Verdict(assigned.Render(1) == soln, "matches", "DOES NOT match") << " solution." << endl;
+
+	cout << "Exiting TestCopy.\n" << endl;
+}
+
+void TestLinearQTree(double tol) {
+	cout << "Entered TestLinearQTree, tolerance: " << tol << endl;
+
+	PNG input = ReadOriginal("kkkk_nnkm-256x224.png");
+
+	cout << "Constructing LinearQTree from image... ";
+	LinearQTree t(input);
+	cout << "done." << endl;
+
+	cout << "Tree contains " << t.CountNodes() << " nodes and " << t.CountLeaves() << " leaves in "
+		<< t.MemoryUsage() << " bytes (" << t.CountNodes() * sizeof(Node) << " bytes as QTree nodes)." << endl;
+
+	cout << "Calling Prune... ";
+	t.Prune(tol);
+	cout << "done." << endl;
+
+	cout << "Pruned tree contains " << t.CountNodes() << " nodes and " << t.CountLeaves() << " leaves." << endl;
+
+	PNG soln;
+	soln.readFromFile("images-soln/soln-kkkk_nnkm-256x224-prune_" + to_string(tol) + "-render_x1.png");
+	cout << "Pruned render " << Verdict(t.Render(1) == soln, "matches", "DOES NOT match") << " solution." << endl;
+
+	cout << "Exiting TestLinearQTree.\n" << endl;
+}
+
+void TestParallelBuild(unsigned int cutoff) {
+	cout << "Entered TestParallelBuild, cutoff: " << cutoff << endl;
+
+	PNG input = ReadOriginal("malachi-60x87.png");
+
+	TaskPool pool;
+	cout << "Constructing QTree from image on " << pool.Size() << " threads... ";
+	QTree t(input, pool, cutoff);
+	cout << "done." << endl;
+
+	PNG soln;
+	soln.readFromFile("images-soln/soln-malachi-render_x1.png");
+	cout << "Parallel build render " << Verdict(t.Render(1) == soln, "matches", "DOES NOT match") << " solution." << endl;
+
+	cout << "Exiting TestParallelBuild.\n" << endl;
+}
+
+void TestBottomUpBuild() {
+	cout << "Entered TestBottomUpBuild" << endl;
+
+	PNG input = ReadOriginal("malachi-60x87.png");
+
+	cout << "Constructing QTree bottom-up from image... ";
+	QTree t(input, BuildOrder::BottomUp);
+	cout << "done." << endl;
+
+	PNG soln;
+	soln.readFromFile("images-soln/soln-malachi-render_x1.png");
+	cout << "Bottom-up build render " << Verdict(t.Render(1) == soln, "matches", "DOES NOT match") << " solution." << endl;
+
+	cout << "Calling RotateCCW... ";
+	t.RotateCCW();
+	cout << "done." << endl;
+
+	soln.readFromFile("images-soln/soln-malachi-rotateccw_x1-render_x1.png");
+	cout << "Rotated render " << Verdict(t.Render(1) == soln, "matches", "DOES NOT match") << " solution." << endl;
+
+	cout << "Exiting TestBottomUpBuild.\n" << endl;
+}
+
+void TestExactAverages(double maxVariance) {
+	cout << "Entered TestExactAverages, max variance: " << maxVariance << endl;
+
+	PNG input = ReadOriginal("kkkk_nnkm-256x224.png");
+
+	cout << "Constructing QTree with exact averages from image... ";
+	QTree t(input, AverageMode::Exact);
+	cout << "done." << endl;
+
+	cout << "Whole image variance is " << t.Variance({0, 0}, {input.width() - 1, input.height() - 1}) << "." << endl;
+	cout << "One-pixel variance " << Verdict(t.Variance({9, 4}, {9, 4}) == 0, "is", "IS NOT") << " 0." << endl;
+
+	// the root's average is the truncated mean of every pixel
+	unsigned long sums[3] = {0, 0, 0};
+	for (unsigned int y = 0; y < input.height(); y++) {
+		for (unsigned int x = 0; x < input.width(); x++) {
+			sums[0] += input.pixelAt(x, y)->r;
+			sums[1] += input.pixelAt(x, y)->g;
+			sums[2] += input.pixelAt(x, y)->b;
+		}
+	}
+	unsigned long area = (unsigned long)input.width() * input.height();
+	PNG rootOnly = t.RenderToDepth(1, 0);
+	RGBAPixel* rootAvg = rootOnly.getPixel(0, 0);
+	bool exact = rootAvg->r == sums[0] / area && rootAvg->g == sums[1] / area && rootAvg->b == sums[2] / area;
+	cout << "Root average " << Verdict(exact, "is", "IS NOT") << " the exact image mean." << endl;
+
+	PNG soln;
+	soln.readFromFile("images-soln/soln-malachi-render_x1.png");
+	QTree malachi(ReadOriginal("malachi-60x87.png"), AverageMode::Exact);
+	cout << "Exact tree render " << Verdict(malachi.Render(1) == soln, "matches", "DOES NOT match") << " solution." << endl;
+
+	cout << "Calling PruneByVariance... ";
+	t.PruneByVariance(maxVariance);
+	cout << "done." << endl;
+
+	cout << "Pruned tree contains " << t.CountNodes() << " nodes and " << t.CountLeaves() << " leaves." << endl;
+
+	cout << "Exiting TestExactAverages.\n" << endl;
+}
+
+void TestParallelPrune(double tol, unsigned int cutoff) {
+	cout << "Entered TestParallelPrune, tolerance: " << tol << ", cutoff: " << cutoff << endl;
+
+	PNG input = ReadOriginal("kkkk_nnkm-256x224.png");
+
+	cout << "Constructing two QTrees from image... ";
+	QTree serial(input);
+	QTree parallel(input);
+	cout << "done." << endl;
+
+	TaskPool pool;
+
+	cout << "Calling Prune... ";
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	serial.Prune(tol);
+	chrono::duration<double, milli> serialTime = chrono::steady_clock::now() - start;
+	cout << "done in " << serialTime.count() << " ms." << endl;
+
+	cout << "Calling Prune on " << pool.Size() << " threads... ";
+	start = chrono::steady_clock::now();
+	parallel.Prune(tol, pool, cutoff);
+	chrono::duration<double, milli> parallelTime = chrono::steady_clock::now() - start;
+	cout << "done in " << parallelTime.count() << " ms (speedup x" << serialTime.count() / parallelTime.count() << ")." << endl;
+
+	cout << "Pruned trees contain " << serial.CountNodes() << " and " << parallel.CountNodes() << " nodes." << endl;
+	cout << "Parallel prune render " << Verdict(parallel.Render(1) == serial.Render(1), "matches", "DOES NOT match") << " serial prune." << endl;
+
+	cout << "Exiting TestParallelPrune.\n" << endl;
+}
+
+void TestPruneToLeafCount(unsigned int leaves) {
+	cout << "Entered TestPruneToLeafCount, leaves: " << leaves << endl;
+
+	PNG input = ReadOriginal("kkkk_nnkm-256x224.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree t(input);
+	cout << "done." << endl;
+
+	cout << "Annotating prune thresholds... ";
+	t.AnnotatePruneThresholds();
+	double tol = t.ToleranceForLeafCount(leaves);
+	cout << "done. Chosen tolerance: " << tol << endl;
+
+	cout << "Pruning a copy at the chosen tolerance and just below it... ";
+	QTree atTolerance(t);
+	atTolerance.Prune(tol);
+	QTree belowTolerance(t);
+	belowTolerance.Prune(nextafter(tol, 0.0));
+	cout << "done." << endl;
+
+	cout << "Pruned trees contain " << atTolerance.CountLeaves() << " and " << belowTolerance.CountLeaves() << " leaves." << endl;
+	bool smallest = atTolerance.CountLeaves() <= leaves && belowTolerance.CountLeaves() > leaves;
+	cout << "Chosen tolerance " << Verdict(smallest, "is", "IS NOT") << " the smallest within " << leaves << " leaves." << endl;
+
+	QTree unannotated(input);
+	cout << "Unannotated tree " << Verdict(unannotated.ToleranceForLeafCount(leaves) == tol, "picks", "DOES NOT pick") << " the same tolerance." << endl;
+
+	t.PruneToLeafCount(leaves);
+	cout << "PruneToLeafCount leaves " << t.CountLeaves() << " leaves." << endl;
+
+	cout << "Exiting TestPruneToLeafCount.\n" << endl;
+}
+
+void TestRenderAtTolerance(unsigned int scale) {
+	cout << "Entered TestRenderAtTolerance, scale: " << scale << endl;
+
+	PNG input = ReadOriginal("kkkk_nnkm-256x224.png");
+
+	cout << "Constructing and annotating QTree from image... ";
+	QTree t(input);
+	t.AnnotatePruneThresholds();
+	cout << "done." << endl;
+
+	double tolerances[] = {0, 0.01, 0.05, 0.2};
+	for (double tol : tolerances) {
+		QTree pruned(input);
+		pruned.Prune(tol);
+		bool same = t.Render(scale, tol) == pruned.Render(scale);
+		cout << "Render at tolerance " << tol << " " << Verdict(same, "matches", "DOES NOT match") << " pruned render." << endl;
+	}
+	QTree unannotated(input);
+	bool same = unannotated.Render(scale, 0.05) == t.Render(scale, 0.05);
+	cout << "Render of an unannotated tree " << Verdict(same, "matches", "DOES NOT match") << " the annotated render." << endl;
+	cout << "Unpruned tree still contains " << t.CountLeaves() << " leaves." << endl;
+
+	cout << "Exiting TestRenderAtTolerance.\n" << endl;
+}
+
+void TestParallelRender(unsigned int scale, unsigned int cutoff) {
+	cout << "Entered TestParallelRender, scale: " << scale << ", cutoff: " << cutoff << endl;
+
+	PNG input = ReadOriginal("kkkk_nnkm-256x224.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree t(input);
+	cout << "done." << endl;
+
+	TaskPool pool;
+
+	cout << "Rendering tree at x" << scale << " scale... ";
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	PNG serial = t.Render(scale);
+	chrono::duration<double, milli> serialTime = chrono::steady_clock::now() - start;
+	cout << "done in " << serialTime.count() << " ms." << endl;
+
+	cout << "Rendering tree on " << pool.Size() << " threads... ";
+	start = chrono::steady_clock::now();
+	PNG parallel = t.Render(scale, pool, cutoff);
+	chrono::duration<double, milli> parallelTime = chrono::steady_clock::now() - start;
+	cout << "done in " << parallelTime.count() << " ms (speedup x" << serialTime.count() / parallelTime.count() << ")." << endl;
+
+	cout << "Parallel render " << Verdict(parallel == serial, "matches", "DOES NOT match") << " serial render." << endl;
+
+	t.Prune(0.05);
+	cout << "Parallel render of pruned tree " << Verdict(t.Render(scale, pool, cutoff) == t.Render(scale), "matches", "DOES NOT match") << " serial render." << endl;
+
+	cout << "Exiting TestParallelRender.\n" << endl;
+}
+
+void TestViewportRender(unsigned int scale) {
+	cout << "Entered TestViewportRender, scale: " << scale << endl;
+
+	PNG input = ReadOriginal("kkkk_nnkm-256x224.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree t(input);
+	t.Prune(0.02);
+	cout << "done." << endl;
+
+	PNG full = t.Render(scale);
+
+	// an interior window that cuts through leaves, and a one-pixel corner
+	pair<unsigned int, unsigned int> viewports[][2] = {
+		{make_pair(101, 57), make_pair(420, 300)},
+		{make_pair(full.width() - 1, full.height() - 1), make_pair(full.width() - 1, full.height() - 1)}
+	};
+	for (auto& viewport : viewports) {
+		pair<unsigned int, unsigned int> ul = viewport[0];
+		pair<unsigned int, unsigned int> lr = viewport[1];
+		PNG crop(lr.first - ul.first + 1, lr.second - ul.second + 1);
+		for (unsigned int y = ul.second; y <= lr.second; y++) {
+			for (unsigned int x = ul.first; x <= lr.first; x++) {
+				*crop.getPixel(x - ul.first, y - ul.second) = *full.getPixel(x, y);
+			}
+		}
+		PNG rendered = t.Render(scale, ul, lr);
+		cout << "Viewport (" << ul.first << "," << ul.second << ")-(" << lr.first << "," << lr.second << ") "
+			<< Verdict(rendered == crop, "matches", "DOES NOT match") << " crop of full render." << endl;
+	}
+
+	// past the corner it is clipped; inverted or outside it is empty
+	PNG clipped = t.Render(scale, make_pair(full.width() - 2, full.height() - 2), make_pair(full.width() + 40, full.height() + 40));
+	PNG inverted = t.Render(scale, make_pair(10, 10), make_pair(9, 20));
+	PNG outside = t.Render(scale, make_pair(full.width(), 0), make_pair(full.width() + 5, 5));
+	bool clips = clipped.width() == 2 && clipped.height() == 2 && *clipped.getPixel(1, 1) == *full.getPixel(full.width() - 1, full.height() - 1);
+	bool empty = inverted.width() == 0 && inverted.height() == 0 && outside.width() == 0 && outside.height() == 0;
+	cout << "Viewport past the corner " << Verdict(clips, "is", "IS NOT") << " clipped to the image." << endl;
+	cout << "Inverted and outside viewports " << Verdict(empty, "are", "ARE NOT") << " empty." << endl;
+
+	cout << "Exiting TestViewportRender.\n" << endl;
+}
+
+void TestLevelOfDetail(unsigned int scale) {
+	cout << "Entered TestLevelOfDetail, scale: " << scale << endl;
+
+	PNG input = ReadOriginal("kkkk_nnkm-256x224.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree t(input);
+	cout << "done." << endl;
+
+	PNG full = t.Render(scale);
+	PNG rootOnly = t.RenderToDepth(scale, 0);
+	cout << "Depth 0 render is " << Verdict(*rootOnly.getPixel(0, 0) == *rootOnly.getPixel(rootOnly.width() - 1, rootOnly.height() - 1), "one colour", "NOT one colour") << "." << endl;
+	cout << "Depth 100 render " << Verdict(t.RenderToDepth(scale, 100) == full, "matches", "DOES NOT match") << " full render." << endl;
+	cout << "Minimum node size 1 render " << Verdict(t.RenderMinNodeSize(scale, 1) == full, "matches", "DOES NOT match") << " full render." << endl;
+
+	for (unsigned int depth = 2; depth <= 6; depth += 2) {
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		PNG preview = t.RenderToDepth(scale, depth);
+		chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+		cout << "Depth " << depth << " render done in " << elapsed.count() << " ms." << endl;
+	}
+	PNG coarse = t.RenderMinNodeSize(scale, 32);
+	cout << "Minimum node size 32 render " << Verdict(coarse != full, "differs from", "MATCHES") << " full render." << endl;
+
+	cout << "Exiting TestLevelOfDetail.\n" << endl;
+}
+
+void TestRenderResized(unsigned int w, unsigned int h) {
+	cout << "Entered TestRenderResized, size: " << w << "x" << h << endl;
+
+	PNG input = ReadOriginal("kkkk_nnkm-256x224.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree t(input);
+	cout << "done." << endl;
+
+	cout << "Resized render at 1x " << Verdict(t.RenderResized(input.width(), input.height()) == t.Render(1), "matches", "DOES NOT match") << " Render(1)." << endl;
+	cout << "Resized render at 3x " << Verdict(t.RenderResized(3 * input.width(), 3 * input.height()) == t.Render(3), "matches", "DOES NOT match") << " Render(3)." << endl;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	PNG thumbnail = t.RenderResized(w, h);
+	chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+	cout << "Thumbnail of " << thumbnail.width() << "x" << thumbnail.height() << " rendered in " << elapsed.count() << " ms." << endl;
+
+	cout << "Exiting TestRenderResized.\n" << endl;
+}
+
+void TestRenderInto(unsigned int scale) {
+	cout << "Entered TestRenderInto, scale: " << scale << endl;
+
+	PNG input = ReadOriginal("malachi-60x87.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree t(input);
+	t.Prune(0.02);
+	cout << "done." << endl;
+
+	PNG expected = t.Render(scale);
+	unsigned int w = expected.width();
+	unsigned int h = expected.height();
+
+	// padded rows, as in a frame buffer
+	size_t stride = 4 * w + 12;
+	vector<unsigned char> buffer(stride * h, 0);
+	t.RenderInto(buffer.data(), w, h, stride);
+
+	PNG received(w, h);
+	for (unsigned int y = 0; y < h; y++) {
+		for (unsigned int x = 0; x < w; x++) {
+			unsigned char* bytes = &buffer[y * stride + 4 * x];
+			*received.getPixel(x, y) = RGBAPixel(bytes[0], bytes[1], bytes[2], bytes[3] / 255.0);
+		}
+	}
+	cout << "Buffer render " << Verdict(received == expected, "matches", "DOES NOT match") << " Render(" << scale << ")." << endl;
+
+	PNG moved = move(expected);
+	cout << "Moved PNG is " << moved.width() << "x" << moved.height() << "; source is now " << expected.width() << "x" << expected.height() << "." << endl;
+
+	cout << "Exiting TestRenderInto.\n" << endl;
+}
+
+void TestMoveAndSwap() {
+	cout << "Entered TestMoveAndSwap" << endl;
+
+	// read input PNGs
+	PNG large;
+	large.readFromFile("images-original/kkkk_nnkm-256x224.png");
+	PNG small;
+	small.readFromFile("images-original/malachi-60x87.png");
+
+	cout << "Constructing QTrees from images... ";
+	QTree t(large);
+	QTree u(small);
+	PNG expected = t.Render(1);
+	cout << "done." << endl;
+
+	cout << "Moving QTrees through a vector... ";
+	vector<QTree> trees;
+	trees.push_back(move(t));
+	trees.push_back(move(u));
+	trees.reserve(16);
+	cout << "done." << endl;
+	cout << "Moved-from tree contains " << t.CountNodes() << " nodes." << endl;
+	cout << "Moved tree render " << Verdict(trees[0].Render(1) == expected, "matches", "DOES NOT match") << " original render." << endl;
+
+	swap(trees[0], trees[1]);
+	cout << "Swapped tree render " << Verdict(trees[1].Render(1) == expected, "matches", "DOES NOT match") << " original render." << endl;
+
+	t = move(trees[1]);
+	t.Prune(0.05);
+	cout << "Move-assigned tree prunes to " << t.CountLeaves() << " leaves." << endl;
+
+	swap(large, small);
+	cout << "Swapped PNGs are " << large.width() << "x" << large.height() << " and " << small.width() << "x" << small.height() << "." << endl;
+
+	cout << "Exiting TestMoveAndSwap.\n" << endl;
+}
+
+void TestPackedPNG() {
+	cout << "Entered TestPackedPNG" << endl;
+
+	// read input PNG both ways
+	PNG input;
+	input.readFromFile("images-original/kkkk_nnkm-256x224.png");
+	PackedPNG packed;
+	packed.readFromFile("images-original/kkkk_nnkm-256x224.png");
+
+	cout << "Pixel sizes: " << sizeof(RGBAPixel) << " bytes unpacked, " << sizeof(RGBA8Pixel) << " bytes packed." << endl;
+	cout << "Unpacked packed image " << Verdict(packed.toPNG() == input, "matches", "DOES NOT match") << " PNG read." << endl;
+	cout << "Packed PNG read " << Verdict(PackedPNG(input) == packed, "matches", "DOES NOT match") << " packed read." << endl;
+
+	cout << "Constructing QTree from image... ";
+	QTree t(input);
+	t.Prune(0.05);
+	cout << "done." << endl;
+	cout << "Packed render " << Verdict(t.RenderPacked(2) == PackedPNG(t.Render(2)), "matches", "DOES NOT match") << " packed Render(2)." << endl;
+
+	cout << "Constructing QTree from packed image... ";
+	QTree fromPacked(packed);
+	fromPacked.Prune(0.05);
+	cout << "done." << endl;
+	cout << "Packed tree render " << Verdict(fromPacked.Render(2) == t.Render(2), "matches", "DOES NOT match") << " tree built from PNG." << endl;
+
+	cout << "Exiting TestPackedPNG.\n" << endl;
+}
+
+void TestStreamingWrite(unsigned int scale) {
+	cout << "Entered TestStreamingWrite, scale: " << scale << endl;
+
+	PNG input = ReadOriginal("kkkk_nnkm-256x224.png");
+
+	cout << "Constructing QTree from image... ";
+	QTree t(input);
+	t.Prune(0.01);
+	PNG output = t.Render(scale);
+	cout << "done." << endl;
+
+	cout << "Streaming x" << scale << " render to memory... ";
+	vector<unsigned char> encoded;
+	size_t pieces = 0;
+	bool written = output.writeToStream([&encoded, &pieces](unsigned char const* data, size_t size) {
+		encoded.insert(encoded.end(), data, data + size);
+		pieces++;
+		return true;
+	});
+	cout << Verdict(written, "done", "FAILED") << ": " << encoded.size() << " bytes in " << pieces << " pieces." << endl;
+
+	vector<unsigned char> decoded;
+	unsigned int w = 0;
+	unsigned int h = 0;
+	unsigned int error = lodepng::decode(decoded, w, h, encoded);
+	bool same = error == 0 && w == output.width() && h == output.height();
+	for (unsigned int i = 0; same && i < w * h; i++) {
+		RGBAPixel* pixel = output.getPixel(i % w, i / w);
+		same = decoded[4 * i] == pixel->r && decoded[4 * i + 1] == pixel->g && decoded[4 * i + 2] == pixel->b
+			&& decoded[4 * i + 3] == (unsigned char) (pixel->a * 255);
+	}
+	cout << "Decoded stream " << Verdict(same, "matches", "DOES NOT match") << " rendered image." << endl;
+
+	cout << "Exiting TestStreamingWrite.\n" << endl;
+}
+
+void TestDeflateEdgeCases() {
+	cout << "Entered TestDeflateEdgeCases" << endl;
+
+	mt19937 random(221);
+	size_t bytes = 0;
+
+	size_t emptyBytes = 0;
+	PNGStreamWriter empty(0, 0, true, [&emptyBytes](unsigned char const* data, size_t size) {
+		emptyBytes += size;
+		return true;
+	});
+	bool refused = !empty.finish() && empty.error() == 93 && emptyBytes == 0;
+	cout << "Empty image " << Verdict(refused, "is", "IS NOT") << " refused with error 93 and no output." << endl;
+
+	vector<unsigned char> single = {12, 34, 56, 78};
+	bool same = StreamRoundTrip(single, 1, 1, true, bytes);
+	cout << "1x1 RGBA image " << Verdict(same, "round-trips", "DOES NOT round-trip") << " in " << bytes << " bytes." << endl;
+	single[3] = 255;
+	same = StreamRoundTrip(single, 1, 1, false, bytes);
+	cout << "1x1 RGB image " << Verdict(same, "round-trips", "DOES NOT round-trip") << " in " << bytes << " bytes." << endl;
+
+	// random bytes leave nothing to match, over several row groups
+	vector<unsigned char> noise(512 * 512 * 4);
+	for (unsigned char& c : noise) {
+		c = random();
+	}
+	same = StreamRoundTrip(noise, 512, 512, true, bytes);
+	cout << "Incompressible image " << Verdict(same, "round-trips", "DOES NOT round-trip") << " in " << bytes << " bytes." << endl;
+
+	// a flat image filters to long zero runs, many times the 258-byte match limit
+	vector<unsigned char> flat(2048 * 64 * 4, 200);
+	same = StreamRoundTrip(flat, 2048, 64, true, bytes);
+	cout << "Flat image " << Verdict(same, "round-trips", "DOES NOT round-trip") << " in " << bytes << " bytes." << endl;
+
+	// rows alternate between two random rows, so each filtered row repeats the
+	// one two rows back: 32768 bytes back for RGB rows 5461 pixels wide, the
+	// farthest deflate can reach, and just out of reach one pixel wider
+	unsigned int widths[] = {4095, 5461, 5462};
+	for (unsigned int w : widths) {
+		vector<unsigned char> rows(2 * w * 4);
+		for (size_t i = 0; i < rows.size(); i++) {
+			rows[i] = (i % 4 == 3) ? 255 : random();
+		}
+		vector<unsigned char> striped;
+		for (unsigned int y = 0; y < 24; y++) {
+			striped.insert(striped.end(), rows.begin() + (y % 2) * w * 4, rows.begin() + (y % 2 + 1) * w * 4);
+		}
+		same = StreamRoundTrip(striped, w, 24, false, bytes);
+		cout << "Striped " << w << "x24 image " << Verdict(same, "round-trips", "DOES NOT round-trip") << " in " << bytes << " bytes." << endl;
+		if (w <= 5461) {
+			cout << "Rows within the window " << Verdict(bytes < w * 24 * 3 / 4, "are", "ARE NOT") << " matched." << endl;
+		}
+	}
+
+	cout << "Exiting TestDeflateEdgeCases.\n" << endl;
+}
+
+void TestMappedFile() {
+	cout << "Entered TestMappedFile" << endl;
+
+	string fileName = "images-original/kkkk_nnkm-256x224.png";
+
+	cout << "Mapping and loading " << fileName << "... ";
+	MappedFile file(fileName);
+	vector<unsigned char> loaded;
+	lodepng::load_file(loaded, fileName);
+	cout << "done: " << file.size() << " bytes, " << (file.mapped() ? "mapped" : "read") << "." << endl;
+
+	bool same = file.error() == 0 && file.size() == loaded.size()
+		&& equal(loaded.begin(), loaded.end(), file.data());
+	cout << "Mapped contents " << Verdict(same, "match", "DO NOT match") << " loaded file." << endl;
+
+	PNG mapped;
+	mapped.readFromFile(fileName);
+	PNG decoded;
+	decoded.resize(mapped.width(), mapped.height());
+	vector<unsigned char> rgba;
+	unsigned int w = 0;
+	unsigned int h = 0;
+	lodepng::decode(rgba, w, h, loaded);
+	for (unsigned int i = 0; i < w * h && i < mapped.width() * mapped.height(); i++) {
+		*decoded.pixelAt(i % w, i / w) = RGBAPixel(rgba[4 * i], rgba[4 * i + 1], rgba[4 * i + 2], rgba[4 * i + 3] / 255.0);
+	}
+	cout << "Image read from mapping " << Verdict(mapped == decoded, "matches", "DOES NOT match") << " image decoded from loaded file." << endl;
+
+	MappedFile missing("images-original/no-such-file.png");
+	cout << "Missing file gives error " << missing.error() << "." << endl;
+
+	MappedFile empty("/dev/null");
+	bool none = empty.error() == 0 && empty.size() == 0 && empty.data() == NULL;
+	cout << "Empty device " << Verdict(none, "gives", "DOES NOT give") << " no contents." << endl;
+
+	cout << "Exiting TestMappedFile.\n" << endl;
+}
+
+void TestMemoryRoundTrip(double tolerance) {
+	cout << "Entered TestMemoryRoundTrip, tolerance: " << tolerance << endl;
+
+	string fileName = "images-original/kkkk_nnkm-256x224.png";
+	vector<unsigned char> body;
+	lodepng::load_file(body, fileName);
+
+	cout << "Decoding " << body.size() << " bytes from memory... ";
+	PNG input;
+	bool read = input.readFromMemory(body.data(), body.size());
+	PNG fromFile;
+	fromFile.readFromFile(fileName);
+	cout << Verdict(read, "done", "FAILED") << "." << endl;
+	cout << "Image read from memory " << Verdict(input == fromFile, "matches", "DOES NOT match") << " image read from file." << endl;
+
+	QTree t(input);
+	t.Prune(tolerance);
+	PNG output = t.Render(1);
+
+	cout << "Encoding render to memory... ";
+	vector<unsigned char> encoded;
+	output.writeToMemory(encoded);
+	vector<unsigned char> sunk;
+	output.writeToMemory([&sunk](unsigned char const* data, size_t size) {
+		sunk.insert(sunk.end(), data, data + size);
+		return true;
+	});
+	cout << "done: " << encoded.size() << " bytes." << endl;
+	cout << "Sink output " << Verdict(sunk == encoded, "matches", "DOES NOT match") << " buffer output." << endl;
+
+	PNG decoded;
+	decoded.readFromMemory(encoded.data(), encoded.size());
+	cout << "Decoded buffer " << Verdict(decoded == output, "matches", "DOES NOT match") << " rendered image." << endl;
+
+	cout << "Exiting TestMemoryRoundTrip.\n" << endl;
+}
+
+void TestQTreeCache(double tolerance) {
+	cout << "Entered TestQTreeCache, tolerance: " << tolerance << endl;
+
+	PNG input = ReadOriginal("kkkk_nnkm-256x224.png");
+	PNG duplicate(input);
+	PNG changed(input);
+	changed.pixelAt(100, 100)->r ^= 1;
+
+	cout << "Input hash: " << hex << input.computeHash() << ", duplicate hash: " << duplicate.computeHash()
+		<< ", changed hash: " << changed.computeHash() << dec << endl;
+
+	QTreeCache cache(2);
+	shared_ptr<const vector<unsigned char>> first = cache.Encoded(input, tolerance, 1);
+	shared_ptr<const vector<unsigned char>> again = cache.Encoded(duplicate, tolerance, 1);
+	shared_ptr<const QTree> tree = cache.Tree(duplicate, tolerance);
+	cache.Encoded(changed, tolerance, 1);
+	cache.Encoded(input, tolerance * 2, 1);
+	cout << "Hits: " << cache.Hits() << ", misses: " << cache.Misses() << ", cached images: " << cache.Size() << endl;
+
+	QTree direct(input);
+	direct.Prune(tolerance);
+	vector<unsigned char> expected;
+	direct.Render(1).writeToMemory(expected);
+	cout << "Duplicate upload " << Verdict(first == again, "shares", "DOES NOT share") << " the cached file." << endl;
+	cout << "Cached file " << Verdict(*first == expected, "matches", "DOES NOT match") << " direct encode." << endl;
+	cout << "Cached tree " << Verdict(tree->Render(1) == direct.Render(1), "matches", "DOES NOT match") << " direct tree." << endl;
+
+	cout << "Exiting TestQTreeCache.\n" << endl;
+}
+
+void TestCompareModes() {
+	cout << "Entered TestCompareModes" << endl;
+
+	PNG input = ReadOriginal("kkkk_nnkm-256x224.png");
+
+	PNG nudged(input);
+	nudged.pixelAt(10, 20)->g += 1;
+	PNG changed(nudged);
+	changed.pixelAt(10, 20)->r += 5;
+	changed.pixelAt(200, 150)->b += 5;
+
+	cout << "Nudged image " << Verdict(nudged == input, "matches", "DOES NOT match") << " input within tolerance, and is "
+		<< Verdict(!nudged.identical(input), "not identical", "IDENTICAL") << "." << endl;
+
+	PNGDiff report = changed.diff(input);
+	cout << "Changed image " << Verdict(changed != input, "differs from", "MATCHES") << " input: " << report.count
+		<< " pixels in (" << report.left << ", " << report.top << ") to (" << report.right << ", " << report.bottom << ")." << endl;
+	bool expected = changed != input && report.count == 2 && report.left == 10 && report.top == 20
+		&& report.right == 200 && report.bottom == 150;
+	cout << "Diff report " << Verdict(expected, "matches", "DOES NOT match") << " the changed pixels." << endl;
+
+	cout << "Exiting TestCompareModes.\n" << endl;
+}
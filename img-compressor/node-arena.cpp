@@ -0,0 +1,145 @@
+/**
+ * @file node-arena.cpp
+ * @description implementation of NodeArena class used to hold the nodes of a QTree
+ */
+
+#include "node-arena.h"
+#include "qtree.h"
+#include <cassert>
+#include <new>
+
+/**
+ * Creates an empty arena that holds no memory.
+ */
+NodeArena::NodeArena() {
+	block = nullptr;
+	capacity = 0;
+	used = 0;
+}
+
+/**
+ * Frees the block, if any.
+ */
+NodeArena::~NodeArena() {
+	Release();
+}
+
+/**
+ * Releases the current block and allocates a new one with room for
+ * exactly count nodes.
+ * @param count number of nodes the block must hold.
+ */
+void NodeArena::Reserve(size_t count) {
+	Release();
+	if (count == 0) {
+		return;
+	}
+	block = static_cast<Node*>(::operator new(count * sizeof(Node)));
+	capacity = count;
+}
+
+/**
+ * Constructs a node in the next free slot of the block.
+ * @pre fewer than Capacity() nodes have been allocated since Reserve.
+ */
+Node* NodeArena::Allocate(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr, RGBAPixel a) {
+	assert(used < capacity);
+	return new (block + used++) Node(ul, lr, a);
+}
+
+/**
+ * Hands out the next count slots as one range, to be filled with
+ * Construct. Lets concurrent builders fill disjoint ranges of the
+ * block without sharing the bump pointer.
+ * @return index of the first slot of the range.
+ * @pre Size() + count <= Capacity().
+ */
+size_t NodeArena::Claim(size_t count) {
+	assert(used + count <= capacity);
+	size_t first = used;
+	used += count;
+	return first;
+}
+
+/**
+ * Constructs a node in a slot previously handed out by Claim.
+ * @pre slot < Size().
+ */
+Node* NodeArena::Construct(size_t slot, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr, RGBAPixel a) {
+	assert(slot < used);
+	return new (block + slot) Node(ul, lr, a);
+}
+
+/**
+ * Frees every node in the arena with one deallocation.
+ * Node has a trivial destructor, so nothing is run per node.
+ */
+void NodeArena::Release() {
+	::operator delete(block);
+	block = nullptr;
+	capacity = 0;
+	used = 0;
+}
+
+/**
+ * Replaces the contents of this arena with a copy of other's block.
+ * Nodes are copied front to back and child pointers are rebased onto
+ * the new block; the tree itself is never walked.
+ * @param other arena to be copied.
+ */
+void NodeArena::CopyFrom(const NodeArena& other) {
+	Reserve(other.used);
+	for (size_t i = 0; i < other.used; i++) {
+		Node* nd = new (block + i) Node(other.block[i]);
+		nd->NW = Rebase(other, nd->NW);
+		nd->NE = Rebase(other, nd->NE);
+		nd->SW = Rebase(other, nd->SW);
+		nd->SE = Rebase(other, nd->SE);
+	}
+	used = other.used;
+}
+
+/**
+ * Exchanges blocks with other. Nodes stay where they are, so pointers
+ * into either arena remain valid and follow their block.
+ * @param other arena to exchange with.
+ */
+void NodeArena::Swap(NodeArena& other) noexcept {
+	swap(block, other.block);
+	swap(capacity, other.capacity);
+	swap(used, other.used);
+}
+
+/**
+ * Maps a node of other onto the node at the same slot of this arena.
+ * Only meaningful after CopyFrom(other).
+ * @param other arena that nd lives in.
+ * @param nd node of other, or nullptr.
+ */
+Node* NodeArena::Rebase(const NodeArena& other, const Node* nd) const {
+	if (nd == nullptr) {
+		return nullptr;
+	}
+	return block + (nd - other.block);
+}
+
+/**
+ * Slot of a node of this arena, for indexing per-node side tables.
+ */
+size_t NodeArena::Index(const Node* nd) const {
+	return nd - block;
+}
+
+/**
+ * Number of nodes handed out since the last Reserve.
+ */
+size_t NodeArena::Size() const {
+	return used;
+}
+
+/**
+ * Number of nodes the current block can hold.
+ */
+size_t NodeArena::Capacity() const {
+	return capacity;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file node-arena.h
+ * @description declaration of NodeArena class, a single-block slab
+ *              that owns every Node of a QTree
+ */
+
+#ifndef _NODE_ARENA_H_
+#define _NODE_ARENA_H_
+
+#include <cstddef>
+#include <utility>
+#include "cs221util/RGBAPixel.h"
+
+using namespace std;
+using namespace cs221util;
+
+class Node;
+
+/**
+ * NodeArena: one contiguous block of Nodes handed out with a bump pointer.
+ *
+ * A QTree knows exactly how many nodes its build will create, so the arena
+ * is sized once up front and never grows. Nodes are never freed one at a
+ * time; Release() drops the whole block in a single deallocation.
+ */
+class NodeArena {
+public:
+    /**
+     * Creates an empty arena that holds no memory.
+     */
+    NodeArena();
+
+    /**
+     * Frees the block, if any.
+     */
+    ~NodeArena();
+
+    /**
+     * Releases the current block and allocates a new one with room for
+     * exactly count nodes.
+     * @param count number of nodes the block must hold.
+     */
+    void Reserve(size_t count);
+
+    /**
+     * Constructs a node in the next free slot of the block.
+     * @pre fewer than Capacity() nodes have been allocated since Reserve.
+     */
+    Node* Allocate(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr, RGBAPixel a);
+
+    /**
+     * Hands out the next count slots as one range, to be filled with
+     * Construct. Lets concurrent builders fill disjoint ranges of the
+     * block without sharing the bump pointer.
+     * @return index of the first slot of the range.
+     * @pre Size() + count <= Capacity().
+     */
+    size_t Claim(size_t count);
+
+    /**
+     * Constructs a node in a slot previously handed out by Claim.
+     * @pre slot < Size().
+     */
+    Node* Construct(size_t slot, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr, RGBAPixel a);
+
+    /**
+     * Frees every node in the arena with one deallocation.
+     */
+    void Release();
+
+    /**
+     * Replaces the contents of this arena with a copy of other's block.
+     * Nodes are copied front to back and child pointers are rebased onto
+     * the new block; the tree itself is never walked.
+     * @param other arena to be copied.
+     */
+    void CopyFrom(const NodeArena& other);
+
+    /**
+     * Exchanges blocks with other. Nodes stay where they are, so pointers
+     * into either arena remain valid and follow their block.
+     * @param other arena to exchange with.
+     */
+    void Swap(NodeArena& other) noexcept;
+
+    /**
+     * Maps a node of other onto the node at the same slot of this arena.
+     * Only meaningful after CopyFrom(other).
+     * @param other arena that nd lives in.
+     * @param nd node of other, or nullptr.
+     */
+    Node* Rebase(const NodeArena& other, const Node* nd) const;
+
+    /**
+     * Slot of a node of this arena, for indexing per-node side tables.
+     */
+    size_t Index(const Node* nd) const;
+
+    /**
+     * Number of nodes handed out since the last Reserve.
+     */
+    size_t Size() const;
+
+    /**
+     * Number of nodes the current block can hold.
+     */
+    size_t Capacity() const;
+
+private:
+    Node* block;     // start of the slab
+    size_t capacity; // number of node slots in the slab
+    size_t used;     // number of slots handed out so far
+
+    NodeArena(const NodeArena& other);            // not copyable, use CopyFrom
+    NodeArena& operator=(const NodeArena& other); // not assignable, use CopyFrom
+};
+
+#endif
@@ -0,0 +1,168 @@
+/**
+ * @file qtree-cache.cpp
+ * @description implementation of QTreeCache, a content-addressed cache of
+ *              pruned trees and their encoded renders
+ */
+
+#include "qtree-cache.h"
+
+/**
+ * Creates an empty cache holding at most capacity images.
+ * @pre capacity > 0
+ */
+QTreeCache::QTreeCache(size_t capacity) : capacity(capacity), hits(0), misses(0) {
+}
+
+/**
+ * The tree of img pruned at tolerance, built and pruned on a miss.
+ */
+shared_ptr<const QTree> QTreeCache::Tree(const PNG& img, double tolerance) {
+	Key key = MakeKey(img, tolerance);
+	{
+		lock_guard<mutex> guard(lock);
+		Entry* entry = Find(key);
+		if (entry != nullptr && entry->tree) {
+			hits++;
+			return entry->tree;
+		}
+		misses++;
+	}
+
+	shared_ptr<const QTree> tree = Build(img, tolerance);
+
+	lock_guard<mutex> guard(lock);
+	Entry& entry = Insert(key);
+	if (!entry.tree) {
+		entry.tree = tree;
+	}
+	return entry.tree;
+}
+
+/**
+ * The PNG file of img pruned at tolerance and rendered at scale, as
+ * PNG::writeToMemory encodes it, or null if encoding fails. On a miss
+ * the cached tree is reused if there is one.
+ * @pre scale > 0
+ */
+shared_ptr<const vector<unsigned char>> QTreeCache::Encoded(const PNG& img, double tolerance, unsigned int scale) {
+	Key key = MakeKey(img, tolerance);
+	shared_ptr<const QTree> tree;
+	{
+		lock_guard<mutex> guard(lock);
+		Entry* entry = Find(key);
+		if (entry != nullptr) {
+			auto found = entry->encoded.find(scale);
+			if (found != entry->encoded.end()) {
+				hits++;
+				return found->second;
+			}
+			tree = entry->tree;
+		}
+		misses++;
+	}
+
+	if (!tree) {
+		tree = Build(img, tolerance);
+	}
+	shared_ptr<vector<unsigned char>> file(new vector<unsigned char>());
+	if (!tree->Render(scale).writeToMemory(*file)) {
+		return nullptr;
+	}
+
+	lock_guard<mutex> guard(lock);
+	Entry& entry = Insert(key);
+	if (!entry.tree) {
+		entry.tree = tree;
+	}
+	return entry.encoded.insert({scale, file}).first->second;
+}
+
+/**
+ * Number of requests answered from the cache.
+ */
+size_t QTreeCache::Hits() const {
+	lock_guard<mutex> guard(lock);
+	return hits;
+}
+
+/**
+ * Number of requests that had to build their result.
+ */
+size_t QTreeCache::Misses() const {
+	lock_guard<mutex> guard(lock);
+	return misses;
+}
+
+/**
+ * Number of images currently cached.
+ */
+size_t QTreeCache::Size() const {
+	lock_guard<mutex> guard(lock);
+	return entries.size();
+}
+
+bool QTreeCache::Key::operator<(const Key& other) const {
+	if (hash != other.hash) {
+		return hash < other.hash;
+	}
+	if (check != other.check) {
+		return check < other.check;
+	}
+	if (width != other.width) {
+		return width < other.width;
+	}
+	if (height != other.height) {
+		return height < other.height;
+	}
+	return tolerance < other.tolerance;
+}
+
+/**
+ * Key of img at tolerance. Both hashes are taken outside the lock.
+ */
+QTreeCache::Key QTreeCache::MakeKey(const PNG& img, double tolerance) {
+	return Key{img.computeHash(), img.computeHash(CheckSeed), img.width(), img.height(), tolerance};
+}
+
+/**
+ * Builds the tree of img and prunes it at tolerance.
+ */
+shared_ptr<const QTree> QTreeCache::Build(const PNG& img, double tolerance) {
+	shared_ptr<QTree> tree(new QTree(img));
+	tree->Prune(tolerance);
+	return tree;
+}
+
+/**
+ * The entry for key, marked most recently used, or nullptr.
+ * @pre lock is held.
+ */
+QTreeCache::Entry* QTreeCache::Find(const Key& key) {
+	auto found = entries.find(key);
+	if (found == entries.end()) {
+		return nullptr;
+	}
+	ages.splice(ages.begin(), ages, found->second.age);
+	return &found->second;
+}
+
+/**
+ * The entry for key, created if absent, evicting the least recently
+ * used entries beyond capacity.
+ * @pre lock is held.
+ */
+QTreeCache::Entry& QTreeCache::Insert(const Key& key) {
+	Entry* existing = Find(key);
+	if (existing != nullptr) {
+		return *existing;
+	}
+
+	ages.push_front(key);
+	Entry& entry = entries[key];
+	entry.age = ages.begin();
+	while (entries.size() > capacity) {
+		entries.erase(ages.back());
+		ages.pop_back();
+	}
+	return entry;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file qtree-cache.h
+ * @description declaration of QTreeCache, a content-addressed cache of
+ *              pruned trees and their encoded renders
+ */
+
+#ifndef _QTREE_CACHE_H_
+#define _QTREE_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "cs221util/PNG.h"
+#include "qtree.h"
+
+using namespace std;
+using namespace cs221util;
+
+/**
+ * QTreeCache: remembers the work done for an image, so that a repeat of
+ * the same pixels skips the build, prune, render and encode.
+ *
+ * Entries are keyed by two independently seeded PNG::computeHash values,
+ * the image size and the prune tolerance. The pixels themselves are not
+ * kept, so two images are taken to be the same when both 64-bit hashes
+ * and the sizes agree. Each entry holds the pruned tree and the PNG
+ * files rendered from it, by scale.
+ * When full, the least recently used entry is dropped. Results are
+ * shared and immutable, so they stay valid after eviction. All functions
+ * may be called from several threads at once; builds run outside the lock.
+ */
+class QTreeCache {
+public:
+    /**
+     * Creates an empty cache holding at most capacity images.
+     * @pre capacity > 0
+     */
+    QTreeCache(size_t capacity);
+
+    /**
+     * The tree of img pruned at tolerance, built and pruned on a miss.
+     */
+    shared_ptr<const QTree> Tree(const PNG& img, double tolerance);
+
+    /**
+     * The PNG file of img pruned at tolerance and rendered at scale, as
+     * PNG::writeToMemory encodes it, or null if encoding fails; a failure
+     * is not cached. On a miss the cached tree is reused if there is one.
+     * @pre scale > 0
+     */
+    shared_ptr<const vector<unsigned char>> Encoded(const PNG& img, double tolerance, unsigned int scale);
+
+    /**
+     * Number of requests answered from the cache.
+     */
+    size_t Hits() const;
+
+    /**
+     * Number of requests that had to build their result.
+     */
+    size_t Misses() const;
+
+    /**
+     * Number of images currently cached.
+     */
+    size_t Size() const;
+
+private:
+    /**
+     * Identity of an image and tolerance.
+     */
+    struct Key {
+        uint64_t hash;        // PNG::computeHash of the image
+        uint64_t check;       // PNG::computeHash(CheckSeed) of the image
+        unsigned int width;   // width of the image
+        unsigned int height;  // height of the image
+        double tolerance;     // prune tolerance
+
+        bool operator<(const Key& other) const;
+    };
+
+    /**
+     * Results cached for one key.
+     */
+    struct Entry {
+        shared_ptr<const QTree> tree;                                    // pruned tree, or null
+        map<unsigned int, shared_ptr<const vector<unsigned char>>> encoded; // PNG files by scale
+        list<Key>::iterator age;                                         // position in ages
+    };
+
+    /**
+     * Seed of the second hash in a key, which confirms the first.
+     */
+    static const uint64_t CheckSeed = 0x9E3779B97F4A7C15;
+
+    size_t capacity;       // maximum number of entries
+    map<Key, Entry> entries;
+    list<Key> ages;        // keys of entries, most recently used first
+    size_t hits;           // requests answered from the cache
+    size_t misses;         // requests that built their result
+    mutable mutex lock;    // guards everything above
+
+    /**
+     * Key of img at tolerance.
+     */
+    static Key MakeKey(const PNG& img, double tolerance);
+
+    /**
+     * Builds the tree of img and prunes it at tolerance.
+     */
+    static shared_ptr<const QTree> Build(const PNG& img, double tolerance);
+
+    /**
+     * The entry for key, marked most recently used, or nullptr.
+     * @pre lock is held.
+     */
+    Entry* Find(const Key& key);
+
+    /**
+     * The entry for key, created if absent, evicting the least recently
+     * used entries beyond capacity.
+     * @pre lock is held.
+     */
+    Entry& Insert(const Key& key);
+};
+
+#endif
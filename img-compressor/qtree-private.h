@@ -1,38 +1,101 @@
-/**
- * @file qtree-private.h
- * @description student declaration of private QTree functions
- *              CPSC 221 PA3
- *
- *              SUBMIT THIS FILE.
- * 
- *				Simply declare your function prototypes here.
- *              No other scaffolding is necessary.
- */
-
-// begin your declarations below 
-void Render(unsigned int scale, PNG& img, Node* nd) const;
-
-RGBAPixel nodeAverage(Node* node);
-
-Node* copy(Node* curr, Node* other);
-
-void clear(Node* curr);
-
-Node* FlipHorizontal(Node *nd);
-
-
-void Swap(Node* n1, Node* n2);
-
-void SwapUneven(Node* n1, Node* n2);
-
-
-Node* RotateCCW(Node* nd, pair<unsigned int, unsigned int> parent_ul);
-
-pair<unsigned int, unsigned int> CalcNewBounds(Node* nd, pair<unsigned int, unsigned int> parent_ul);
-
-
-bool GetChildren(Node * root, RGBAPixel avg, double tolerance);
-
-void Prune(Node * node, double tolerance);
-
+/**
+ * @file qtree-private.h
+ * @description student declaration of private QTree functions
+ *              CPSC 221 PA3
+ *
+ *              SUBMIT THIS FILE.
+ * 
+ *				Simply declare your function prototypes here.
+ *              No other scaffolding is necessary.
+ */
+
+// begin your declarations below 
+void Render(unsigned int scale, PNG& img, Node* nd) const;
+
+void Render(unsigned int scale, PNG& img, Node* nd, double tolerance, const vector<double>& thresholds) const;
+
+void Paint(unsigned int scale, PNG& img, Node* nd) const;
+
+void Render(unsigned int scale, PNG& img, Node* nd, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const;
+
+void RenderLevel(unsigned int scale, PNG& img, Node* nd, unsigned int depth, unsigned int maxDepth, unsigned int minSize) const;
+
+void ResizedSpans(Node* nd, unsigned int w, unsigned int h, const function<void(unsigned int, unsigned int, unsigned int, unsigned int, const RGBAPixel&)>& fill) const;
+
+static void FillBytes(unsigned char* pixels, size_t stride, unsigned int left, unsigned int top, unsigned int span, unsigned int rows, const RGBAPixel& color);
+
+static unsigned int TargetStart(unsigned int x, unsigned int source, unsigned int target);
+
+void Render(unsigned int scale, PNG& img, Node* nd, TaskPool& pool, unsigned int cutoff) const;
+
+RGBAPixel nodeAverage(Node* node);
+
+NodeArena arena; // owns every node of the tree
+
+shared_ptr<const SummedAreaTable> stats; // image statistics, only kept in AverageMode::Exact
+
+void ExactAverages(Node* nd);
+
+void PruneByVariance(Node* nd, double maxVariance);
+
+static size_t NodeCount(unsigned int w, unsigned int h, map<pair<unsigned int, unsigned int>, size_t>& memo);
+
+static size_t LookupNodeCount(unsigned int w, unsigned int h, const map<pair<unsigned int, unsigned int>, size_t>& memo);
+
+Node* BuildNode(const PackedPNG& img, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr);
+
+Node* BuildBottomUp(const PNG& img);
+
+void AverageParents(const vector<Node*>& parents, SiblingBatch& batch);
+
+void AverageLevels(Node* nd);
+
+static vector<vector<pair<unsigned int, unsigned int>>> SplitLevels(unsigned int length);
+
+Node* BuildNode(const PNG& img, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr, size_t slot,
+	TaskPool& pool, unsigned int cutoff, const map<pair<unsigned int, unsigned int>, size_t>& counts);
+
+Node* FlipHorizontal(Node *nd);
+
+
+void Swap(Node* n1, Node* n2);
+
+void SwapUneven(Node* n1, Node* n2);
+
+
+Node* RotateCCW(Node* nd, pair<unsigned int, unsigned int> parent_ul);
+
+pair<unsigned int, unsigned int> CalcNewBounds(Node* nd, pair<unsigned int, unsigned int> parent_ul);
+
+
+bool GetChildren(Node * root, RGBAPixel avg, double tolerance);
+
+void SummarizeLeaves(Node* nd, vector<LeafBounds>& bounds) const;
+
+void MergeLeafBounds(Node* nd, vector<LeafBounds>& bounds) const;
+
+bool WithinTolerance(Node* nd, double tolerance, const vector<LeafBounds>& bounds);
+
+void Prune(Node * node, double tolerance, const vector<LeafBounds>& bounds);
+
+void SummarizeLeaves(Node* nd, vector<LeafBounds>& bounds, TaskPool& pool, unsigned int cutoff);
+
+void Prune(Node* node, double tolerance, const vector<LeafBounds>& bounds, TaskPool& pool, unsigned int cutoff);
+
+static size_t NodeArea(const Node* nd);
+
+vector<double> pruneThresholds; // collapse tolerance of each node by arena slot, once annotated
+
+void ComputePruneThresholds(vector<double>& thresholds) const;
+
+void ComputePruneThresholds(Node* nd, const vector<LeafBounds>& bounds, vector<double>& thresholds) const;
+
+double MaxLeafDistance(Node* nd, RGBAPixel avg, const vector<LeafBounds>& bounds, double best) const;
+
+void CollectPruneEvents(vector<pair<double, int>>& leafEvents, vector<pair<double, int>>& nodeEvents) const;
+
+void CollectPruneEvents(Node* nd, double survives, const vector<double>& thresholds, vector<pair<double, int>>& leafEvents, vector<pair<double, int>>& nodeEvents) const;
+
+static double SmallestTolerance(vector<pair<double, int>>& events, long count, long target);
+
 Node* Rotate(Node * node);
\ No newline at end of file
@@ -1,761 +1,1929 @@
-/**
- * @file qtree.cpp
- * @description student implementation of QTree class used for storing image data
- *              CPSC 221 PA3
- *
- *              SUBMIT THIS FILE
- */
-
-#include "qtree.h"
-#include <iostream>
-#include <cmath>
-
-/**
- * Constructor that builds a QTree out of the given PNG.
- * Every leaf in the tree corresponds to a pixel in the PNG.
- * Every non-leaf node corresponds to a rectangle of pixels
- * in the original PNG, represented by an (x,y) pair for the
- * upper left corner of the rectangle and an (x,y) pair for
- * lower right corner of the rectangle. In addition, the Node
- * stores a pixel representing the average color over the
- * rectangle.
- *
- * The average color for each node in your implementation MUST
- * be determined in constant time. HINT: this will lead to nodes
- * at shallower levels of the tree to accumulate some error in their
- * average color value, but we will accept this consequence in
- * exchange for faster tree construction.
- * Note that we will be looking for specific color values in our
- * autograder, so if you instead perform a slow but accurate
- * average color computation, you will likely fail the test cases!
- *
- * Every node's children correspond to a partition of the
- * node's rectangle into (up to) four smaller rectangles. The node's
- * rectangle is split evenly (or as close to evenly as possible)
- * along both horizontal and vertical axes. If an even split along
- * the vertical axis is not possible, the extra line will be included
- * in the left side; If an even split along the horizontal axis is not
- * possible, the extra line will be included in the upper side.
- * If a single-pixel-wide rectangle needs to be split, the NE and SE children
- * will be null; likewise if a single-pixel-tall rectangle needs to be split,
- * the SW and SE children will be null.
- *
- * In this way, each of the children's rectangles together will have coordinates
- * that when combined, completely cover the original rectangle's image
- * region and do not overlap.
- */
-QTree::QTree(const PNG& imIn) {
-	height = imIn.height();
-	width = imIn.width();
-	pair<unsigned int, unsigned int> ul = {0,0};
-	pair<unsigned int, unsigned int> lr = {width-1, height-1};
-	root = BuildNode(imIn, ul,lr);
-}
-
-/**
- * Overloaded assignment operator for QTrees.
- * Part of the Big Three that we must define because the class
- * allocates dynamic memory. This depends on your implementation
- * of the copy and clear funtions.
- *
- * @param rhs The right hand side of the assignment statement.
- */
-QTree& QTree::operator=(const QTree& rhs) {
-	// ADD YOUR IMPLEMENTATION BELOW
-	if (this != &rhs) {
-		// this and rhs are not the same object in memory
-		Clear();
-		Copy(rhs);
-	}
-	return *this;
-}
-
-/**
- * Render returns a PNG image consisting of the pixels
- * stored in the tree. may be used on pruned trees. Draws
- * every leaf node's rectangle onto a PNG canvas using the
- * average color stored in the node.
- *
- * For up-scaled images, no color interpolation will be done;
- * each rectangle is fully rendered into a larger rectangular region.
- *
- * @param scale multiplier for each horizontal/vertical dimension
- * @pre scale > 0
- */
-PNG QTree::Render(unsigned int scale) const {
-	PNG rendered = PNG(width*scale, height*scale);
-	Render(scale,rendered,root);
-	return rendered;
-}
-
-
-void QTree::Render(unsigned int scale, PNG& img, Node* nd) const {
-	if (nd == NULL) {
-		return ;
-	}
-
-	if (nd->SE == NULL && nd->NE == NULL && nd->SW == NULL && nd->NW == NULL) {
-		for (unsigned int x = nd->upLeft.first*scale; x <= (nd->lowRight.first + 1) * scale - 1; x++) {
-			for (unsigned int y = nd->upLeft.second*scale; y <= (nd->lowRight.second + 1) * scale - 1; y++) {
-				RGBAPixel *pixel = img.getPixel(x,y);
-				*pixel = nd->avg;
-			}
-		}
-	}
-
-	Render(scale, img, nd->SE);
-	Render(scale, img, nd->NE);
-	Render(scale, img, nd->SW);
-	Render(scale, img, nd->NW);
-	
-	return ;
-}
-
-/**
- *  Prune function trims subtrees as high as possible in the tree.
- *  A subtree is pruned (cleared) if all of the subtree's leaves are within
- *  tolerance of the average color stored in the root of the subtree.
- *  NOTE - you may use the distanceTo function found in RGBAPixel.h
- *  Pruning criteria should be evaluated on the original tree, not
- *  on any pruned subtree. (we only expect that trees would be pruned once.)
- *
- * You may want a recursive helper function for this one.
- *
- * @param tolerance maximum RGBA distance to qualify for pruning
- * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
- */
-void QTree::Prune(double tolerance) {
-	// ADD YOUR IMPLEMENTATION BELOW
-	Prune(root, tolerance);
-	
-}
-
-void QTree::Prune(Node * node, double tolerance) {
-	if (node == NULL) {
-		return;
-	}
-	RGBAPixel avg = node->avg;
-	bool withinTolerance = GetChildren(node, avg, tolerance);
-
-	if (withinTolerance) {
-		clear(node->SE);
-		clear(node->NE);
-		clear(node->SW);
-		clear(node->NW);
-		node->SE = nullptr;
-		node->SW = nullptr;
-		node->NW = nullptr;
-		node->NE = nullptr;
-		return;
-	} 
-
-	Prune(node->NW, tolerance);
-	Prune(node->NE, tolerance);
-	Prune(node->SW, tolerance);
-	Prune(node->SE, tolerance);
-	return;
-}
-
-
-
-bool QTree::GetChildren(Node * root, RGBAPixel avg, double tolerance) {
-	if (root == NULL) {
-		return true;
-	}
-
-	if (root->SE == NULL && root->NE == NULL && root->SW == NULL && root->NW == NULL) {
-		if (avg.distanceTo(root->avg) > tolerance) {
-	 		return false;
-	 	}
-	}
-
-	bool within = true;
-
-	within = GetChildren(root->SE, avg, tolerance);
-	if (!within) {
-		return within;
-	}
-
-	within = GetChildren(root->SW, avg, tolerance);
-
-	if (!within) {
-		return within;
-	}
-	within = GetChildren(root->NE, avg, tolerance);
-
-	if (!within) {
-		return within;
-	}
-	within = GetChildren(root->NW, avg, tolerance);
-
-	if (!within) {
-		return within;
-	}
-
-	return within;
-}
-
-
-/**
- *  FlipHorizontal rearranges the contents of the tree, so that
- *  its rendered image will appear mirrored across a vertical axis.
- *  This may be called on a previously pruned/flipped/rotated tree.
- *
- *  After flipping, the NW/NE/SW/SE pointers must map to what will be
- *  physically rendered in the respective NW/NE/SW/SE corners, but it
- *  is no longer necessary to ensure that 1-pixel wide rectangles have
- *  null eastern children
- *  (i.e. after flipping, a node's NW and SW pointers may be null, but
- *  have non-null NE and SE)
- * 
- *  You may want a recursive helper function for this one.
- */
-void QTree::FlipHorizontal() {
-	root = FlipHorizontal(root);
-	
-}
-
-
-Node* QTree::FlipHorizontal(Node *nd) {
-	if (nd == nullptr) {
-		return nullptr;
-	}
-	Node* NW = nd->NW;
-	Node* NE = nd->NE;
-	Node* SW = nd->SW;
-	Node* SE = nd->SE;
-	pair<unsigned int, unsigned int> NW_ul, NW_lr;
-	pair<unsigned int, unsigned int> NE_lr;
-	pair<unsigned int, unsigned int> SW_ul;
-	pair<unsigned int, unsigned int> SE_ul, SE_lr;
-	
-
-
-	if (nd->NE != NULL) {
-		NE_lr = {nd->upLeft.first + NE->lowRight.first - NE->upLeft.first, NE->lowRight.second};
-		nd->NE->upLeft = nd->upLeft;
-		nd->NE->lowRight = NE_lr;
-	}
-	if (nd->NW != NULL) {
-		unsigned int NE_w = 0;
-		if (NE != NULL) {
-			NE_w = NE->lowRight.first - NE->upLeft.first + 1;
-		}
-		NW_ul = {nd->upLeft.first + NE_w, nd->upLeft.second};
-		NW_lr = {nd->lowRight.first, NW->lowRight.second};
-		nd->NW->upLeft = NW_ul;
-		nd->NW->lowRight = NW_lr;
-
-	}
-	if (nd->SE != NULL) {
-		SE_ul = {nd->upLeft.first, SE->upLeft.second};
-		SE_lr = {nd->upLeft.first + SE->lowRight.first - SE->upLeft.first, SE->lowRight.second};
-		nd->SE->upLeft = SE_ul;
-		nd->SE->lowRight = SE_lr;
-	}
-	if (nd->SW != NULL) {
-		unsigned int SE_w = 0;
-		if (SE != NULL) {
-			SE_w = SE->lowRight.first - SE->upLeft.first + 1;
-		}
-		SW_ul = {nd->upLeft.first + SE_w, SW->upLeft.second};
-		nd->SW->upLeft = SW_ul;
-		nd->SW->lowRight = nd->lowRight;
-	}
-	swap(nd->NW,nd->NE);
-	swap(nd->SW,nd->SE);
-	Node* old_NW = nd->NW;
-	Node* old_NE = nd->NE;
-	Node* old_SW = nd->SW;
-	Node* old_SE = nd->SE;
-	nd->NE = FlipHorizontal(old_NE);
-	nd->NW = FlipHorizontal(old_NW);
-	nd->SW = FlipHorizontal(old_SW);
-	nd->SE = FlipHorizontal(old_SE);
-	return nd;
-}
-
-
-/**
- *  RotateCCW rearranges the contents of the tree, so that its
- *  rendered image will appear rotated by 90 degrees counter-clockwise.
- *  This may be called on a previously pruned/flipped/rotated tree.
- *
- *  Note that this may alter the dimensions of the rendered image, relative
- *  to its original dimensions.
- *
- *  After rotation, the NW/NE/SW/SE pointers must map to what will be
- *  physically rendered in the respective NW/NE/SW/SE corners, but it
- *  is no longer necessary to ensure that 1-pixel tall or wide rectangles
- *  have null eastern or southern children
- *  (i.e. after rotation, a node's NW and NE pointers may be null, but have
- *  non-null SW and SE, or it may have null NW/SW but non-null NE/SE)
- *
- *  You may want a recursive helper function for this one.
- */
-// void QTree::RotateCCW() {
-//     // recalculate width / height
-//     // unsigned int temp = width;
-//     // width = height; 
-//     // height = temp;
-//     root = RotateCCW(root, root->upLeft);
-// 	// width = root->lowRight.first + 1;
-// 	// height = root->lowRight.second + 1;
-// 	width = 200;
-// 	height = 200;
-// }
-
-// Node* QTree::RotateCCW(Node* nd, pair<unsigned int, unsigned int> parent_ul) {
-//     if (nd == NULL) {
-//      return nd;
-//     }
-// 	nd->upLeft = parent_ul;
-
-//     Node* NW = nd->NW;
-//     Node* NE = nd->NE;
-//     Node* SW = nd->SW;
-//     Node* SE = nd->SE;
-
-//     pair<unsigned int, unsigned int> NW_ul, NW_lr;
-//     pair<unsigned int, unsigned int> NE_ul, NE_lr;
-//     pair<unsigned int, unsigned int> SW_ul, SW_lr;
-//     pair<unsigned int, unsigned int> SE_ul, SE_lr;
-// 	// unsigned int nw_x = nd->upLeft.first, ne_x = nd->upLeft.first, sw_x = nd->upLeft.first, se_x = nd->upLeft.first;
-// 	// unsigned int nw_y = nd->upLeft.second, ne_y = nd->upLeft.second, sw_y = nd->upLeft.second, se_y = nd->upLeft.second;
-// 	pair<unsigned int, unsigned int> nw, ne, sw, se = nd->upLeft;
-
-//     if (NE != NULL) {
-//      NE_ul = nd->upLeft;
-//      NE_lr = {nd->upLeft.first + NE->lowRight.second - NE->upLeft.second, nd->upLeft.second + NE->lowRight.first - NE->upLeft.first};
-//      nd->NE->upLeft = NE_ul;
-//      nd->NE->lowRight = NE_lr;
-//     }
-//     if (SE != NULL) {
-//      unsigned int NE_w = 0;
-//      if (NE != NULL) {
-//          NE_w = NE->lowRight.second - NE->upLeft.second + 1;
-//      }
-//      SE_ul = {nd->upLeft.first + NE_w, nd->upLeft.second};
-//      SE_lr = {nd->upLeft.first + SE->lowRight.second - SE->upLeft.second + NE_w, nd->upLeft.second + SE->lowRight.first - SE->upLeft.first};
-//      nd->SE->upLeft = SE_ul;
-//      nd->SE->lowRight = SE_lr;
-//     }
-//     if (NW != NULL) {
-//      unsigned int NE_h = 0;
-//      if (NE != NULL || SE != NULL) {
-// 		if (NE != NULL) {
-// 			NE_h = NE->lowRight.first - NE->upLeft.first + 1;
-// 		} else {
-// 			NE_h = SE->lowRight.first - SE->upLeft.first + 1;
-// 		}
-//      } 
-//      NW_ul = {nd->upLeft.first, nd->upLeft.second + NE_h};
-//      NW_lr = {nd->upLeft.first + NW->lowRight.second - NW->upLeft.second, nd->upLeft.second + NW->lowRight.first - NW->upLeft.first + NE_h};
-
-//      nd->NW->upLeft = NW_ul;
-//      nd->NW->lowRight = NW_lr;
-//     }
-//     if (SW != NULL) {
-//      unsigned int NW_w = 0;
-//      unsigned int SE_h = 0;
-//      if (NE != NULL || SE != NULL) {
-// 		if (NE != NULL) {
-// 			SE_h = NE->lowRight.first - NE->upLeft.first + 1;
-// 		} else {
-// 			SE_h = SE->lowRight.first - SE->upLeft.first + 1;
-// 		}
-//      }
-//      if (NW != NULL) {
-//          NW_w = NW->lowRight.second - NW->upLeft.second + 1;
-//      }
-//      SW_ul = {nd->upLeft.first + NW_w, nd->upLeft.second + SE_h};
-//      SW_lr = {nd->upLeft.first + SW->lowRight.second - SW->upLeft.second + NW_w, nd->upLeft.second + SW->lowRight.first - SW->upLeft.first + SE_h};
-
-//      nd->SW->upLeft = SW_ul;
-//      nd->SW->lowRight = SW_lr;
-//     }
-// 	swap(nd->NW, nd->NE);
-// 	swap(nd->SE, nd->SW);
-// 	swap(nd->SW, nd->NE);
-
-//     Node* old_NW = nd->NW;
-//     Node* old_NE = nd->NE;
-//     Node* old_SW = nd->SW;
-//     Node* old_SE = nd->SE;
-
-// 	// if (NW != NULL) {
-// 	// 	ne_x += NW->lowRight.first - NW->upLeft.first + 1;
-// 	// }
-// 	// if (NW != NULL || NE != NULL) {
-// 	// 	sw_y = (NW != NULL) ? NW->lowRight.second - NW->upLeft.second + 1 : NE->lowRight.second - NE->upLeft.second + 1;
-// 	// 	se_y += (NW != NULL) ? NW->lowRight.second - NW->upLeft.second + 1 : NE->lowRight.second - NE->upLeft.second + 1;
-// 	// }
-// 	// if (SW != NULL) {
-// 	// 	se_x += SW->lowRight.first - SW->upLeft.first + 1;
-// 	// }
-
-// 	if (NE != NULL) {
-// 		ne = NE->upLeft;
-// 	}
-// 	if (NW != NULL) {
-// 		nw = NW->upLeft;
-// 	}
-// 	if (SW != NULL) {
-// 		sw = SW->upLeft;
-// 	}
-// 	if (SE != NULL) {
-// 		se = SE->upLeft;
-// 	}
-// 	nd->NE = RotateCCW(old_NE, ne);
-//     nd->NW = RotateCCW(old_NW, nw);
-//     nd->SW = RotateCCW(old_SW, sw);
-//     nd->SE = RotateCCW(old_SE, se);
-//     return nd;
-// }
-
-
-
-
-/**
- *  RotateCCW rearranges the contents of the tree, so that its
- *  rendered image will appear rotated by 90 degrees counter-clockwise.
- *  This may be called on a previously pruned/flipped/rotated tree.
- *
- *  Note that this may alter the dimensions of the rendered image, relative
- *  to its original dimensions.
- *
- *  After rotation, the NW/NE/SW/SE pointers must map to what will be
- *  physically rendered in the respective NW/NE/SW/SE corners, but it
- *  is no longer necessary to ensure that 1-pixel tall or wide rectangles
- *  have null eastern or southern children
- *  (i.e. after rotation, a node's NW and NE pointers may be null, but have
- *  non-null SW and SE, or it may have null NW/SW but non-null NE/SE)
- *
- *  You may want a recursive helper function for this one.
- */
-void QTree::RotateCCW() {
-	// ADD YOUR IMPLEMENTATION BELOW
-	if (root != NULL) {
-		pair<unsigned int, unsigned int> newLR = {root->lowRight.second, root->lowRight.first};
-		root->lowRight = newLR;
-	}
-	root = Rotate(root);
-	unsigned int temp = height;
-	height = width;
-	width = temp;
-	
-}
-
-Node* QTree::Rotate(Node * node) {
-	if (node == NULL) {
-		return nullptr;
-	}
-
-	vector<Node*> temp = {node->NW, node->NE, node->SW, node->SE};
-
-	node->NW = temp[1];
-	node->NE = temp[3];
-	node->SW = temp[0];
-	node->SE = temp[2];
-
-	int NW_W = 0;
-	int NW_H = 0;
-	pair<unsigned int, unsigned int> NW_UL;
-	pair<unsigned int, unsigned int> NW_LR;
-
-	pair<unsigned int, unsigned int> NE_UL;
-	int NE_W;
-	int NE_H;
-	pair<unsigned int, unsigned int> NE_LR;
-
-	pair<unsigned int, unsigned int> SW_UL;
-	int SW_W = 0;
-	int SW_H = 0;
-	pair<unsigned int, unsigned int> SW_LR;
-
-	pair<unsigned int, unsigned int> SE_UL;
-	int SE_W;
-	int SE_H;
-	pair<unsigned int, unsigned int> SE_LR;
-
-
-	if (node->NW != NULL) {
-		NW_UL = node->upLeft;
-		NW_W = temp[1]->lowRight.first - temp[1]->upLeft.first;
-		NW_H = temp[1]->lowRight.second - temp[1]->upLeft.second;
-		NW_LR = {NW_UL.first + NW_H, NW_UL.second + NW_W};
-	}
-
-	if (node->NE != NULL) {
-		NE_UL = node->upLeft;
-		if (node->NW != NULL) {
-			NE_UL = {NW_UL.first + NW_H + 1, NW_UL.second};
-		}
-		NE_W = temp[3]->lowRight.first - temp[3]->upLeft.first;
-		NE_H = temp[3]->lowRight.second - temp[3]->upLeft.second;
-		NE_LR = {NE_UL.first + NE_H, NE_UL.second + NE_W};
-	}
-
-	if (node->SW != NULL) {
-		SW_UL = node->upLeft;
-		if (node->NW != NULL) {
-			SW_UL = {NW_UL.first, NW_UL.second + NW_W + 1};
-		}
-		SW_W = temp[0]->lowRight.first - temp[0]->upLeft.first;
-		SW_H = temp[0]->lowRight.second - temp[0]->upLeft.second;
-		SW_LR = {SW_UL.first + SW_H, SW_UL.second + SW_W};
-	}
-	
-	if (node->SE != NULL) {
-		SE_UL = node->upLeft;
-		if (node->SW != NULL) {
-			SE_UL = {SW_UL.first + SW_H + 1, SW_UL.second};
-		} else if (node->NE != NULL) {
-			SE_UL = {NE_UL.first, NE_UL.second + NE_W + 1};
-		}
-		SE_W = temp[2]->lowRight.first - temp[2]->upLeft.first;
-		SE_H = temp[2]->lowRight.second - temp[2]->upLeft.second;
-		SE_LR = {SE_UL.first + SE_H, SE_UL.second + SE_W};
-	}
-
-	if (node->NW != NULL) {
-		node->NW->upLeft = NW_UL;
-		node->NW->lowRight = NW_LR;
-	}
-
-	if (node->NE != NULL) {
-		node->NE->upLeft = NE_UL;
-		node->NE->lowRight = NE_LR;
-	}
-
-	if (node->SW != NULL) {
-		node->SW->upLeft = SW_UL;
-		node->SW->lowRight = SW_LR;
-	}
-
-	if (node->SE != NULL) {
-		node->SE->upLeft = SE_UL;
-		node->SE->lowRight = SE_LR;
-	}
-
-
-	node->NW = Rotate(node->NW);
-	node->NE = Rotate(node->NE);
-	node->SE = Rotate(node->SE);
-	node->SW = Rotate(node->SW);
-
-	return node;
-}
-
-// pair<unsigned int, unsigned int> QTree::CalcNewBounds(Node *nd, pair<unsigned int, unsigned int> parent_ul) {
-// 	int nd_width = nd->lowRight.first - nd->upLeft.first + 1;
-// 	int nd_height = nd->lowRight.second - nd->upLeft.second + 1;
-// 	int diff = nd_width - nd_height;
-// 	unsigned int nd_x = nd->upLeft.first;
-// 	unsigned int nd_y = nd->upLeft.second;
-
-// 	if (nd_width == nd_height) {
-// 		return nd->upLeft;
-// 	}
-// 	if (nd->upLeft.first != parent_ul.first) {
-// 		if (nd_height > nd_width) {
-// 			nd_x = nd->upLeft.first + abs(diff);
-// 		} else {
-// 			nd_x = nd->upLeft.first - abs(diff);
-// 		}
-// 	}
-// 	if (nd->upLeft.second != parent_ul.second) {
-// 		if (nd_height > nd_width) {
-// 			nd_y = nd->upLeft.second - abs(diff);
-// 		} else {
-// 			nd_y = nd->upLeft.second + abs(diff);
-// 		}
-// 	}
-// 	pair<unsigned int, unsigned int> res = {nd_x, nd_y};
-// 	return res;
-// }
-
-/**
- * Destroys all dynamically allocated memory associated with the
- * current QTree object. Complete for PA3.
- * You may want a recursive helper function for this one.
- */
-void QTree::Clear() {
-	// ADD YOUR IMPLEMENTATION BELOW
-	clear(root);
-	root = nullptr;
-}
-
-void QTree::clear(Node* curr) {
-	if (curr == nullptr) {
-		return;
-	}
-
-	clear(curr->NW);
-	clear(curr->NE);
-	clear(curr->SW);
-	clear(curr->SE);
-
-	Node* temp = curr;
-	curr = nullptr;
-	delete temp;
-	return;
-}
-
-/**
- * Copies the parameter other QTree into the current QTree.
- * Does not free any memory. Called by copy constructor and operator=.
- * You may want a recursive helper function for this one.
- * @param other The QTree to be copied.
- */
-void QTree::Copy(const QTree& other) {
-	// ADD YOUR IMPLEMENTATION BELOW
-	root = copy(root, other.root);
-}
-
-Node* QTree::copy(Node* curr, Node* other) {
-	if (other == nullptr) {
-		return curr;
-	}
-	if (curr == nullptr) {
-		curr = new Node({0,0}, {0,0}, RGBAPixel());
-	}
-	
-	curr->avg = other->avg;
-	curr->upLeft = {other->upLeft.first, other->upLeft.second};
-	curr->lowRight = {other->lowRight.first, other->lowRight.second};
-
-	curr->NW = copy(curr->NW, other->NW);
-	curr->NE = copy(curr->NE, other->NE);
-	curr->SW = copy(curr->SW, other->SW);
-	curr->SE = copy(curr->SE, other->SE);
-
-	return curr;
-}
-
-/**
- * Private helper function for the constructor. Recursively builds
- * the tree according to the specification of the constructor.
- * @param img reference to the original input image.
- * @param ul upper left point of current node's rectangle.
- * @param lr lower right point of current node's rectangle.
- */
-Node* QTree::BuildNode(const PNG& img, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) {
-	// Replace the line below with your implementation
-	int x = lr.first + 1 - ul.first;
-	int y = lr.second + 1 - ul.second;
-
-	if (x == 0 || y == 0) {
-		return NULL;
-	}
-	
-	Node* nd = new Node(ul, lr, RGBAPixel());
-
-	if (x == 1 && y == 1) {
-		RGBAPixel* pixel = img.getPixel(ul.first, ul.second);
-		nd->avg = *pixel;
-		return nd;
-	}
-	
-	int larger_x = x - (x/2);
-	int larger_y = y - (y/2);
-
-	pair<unsigned int, unsigned int> NW_lr = {ul.first + larger_x - 1, ul.second + larger_y - 1};
-
-	pair<unsigned int, unsigned int> NE_ul = {ul.first + larger_x, ul.second};
-	pair<unsigned int, unsigned int> NE_lr = {lr.first, ul.second + larger_y - 1};
-
-	pair<unsigned int, unsigned int> SW_ul = {ul.first, ul.second + larger_y};
-	pair<unsigned int, unsigned int> SW_lr = {ul.first + larger_x - 1, lr.second};
-
-	pair<unsigned int, unsigned int> SE_ul = {ul.first + larger_x, ul.second + larger_y};
-
-	if (x != 1 && y != 1) {
-		nd->NW = BuildNode(img, ul, NW_lr);
-		nd->NE = BuildNode(img, NE_ul, NE_lr);
-		nd->SW = BuildNode(img, SW_ul, SW_lr);
-		nd->SE = BuildNode(img, SE_ul, lr);
-	} else if (y == 1) {
-		nd->NE = BuildNode(img, NE_ul, NE_lr);
-		nd->NW = BuildNode(img, ul, NW_lr);
-	} else {
-		nd->SW = BuildNode(img, SW_ul, SW_lr);
-		nd->NW = BuildNode(img, ul, NW_lr);
-	}
-
-	nd->avg = nodeAverage(nd);
-	
-	return nd;
-}
-
-// /*********************************************************/
-// /*** IMPLEMENT YOUR OWN PRIVATE MEMBER FUNCTIONS BELOW ***/
-// /*********************************************************/
-
-RGBAPixel QTree::nodeAverage(Node* node) {
-
-	int width = 0;
-	int height = 0;
-	int area = 0;
-
-	Node* NW = node->NW;
-	Node* NE = node->NE;
-	Node* SW = node->SW;
-	Node* SE = node->SE;
-
-	int red = 0;
-	int green = 0;
-	int blue = 0;
-	int totalArea = 0;
-
-	if (NW != nullptr) {
-		width = NW->lowRight.first - NW->upLeft.first + 1;
-		height = NW->lowRight.second - NW->upLeft.second + 1;
-		area = width * height;
-		
-		red += (NW->avg.r * area);
-		green += (NW->avg.g * area);
-		blue += (NW->avg.b * area);
-		totalArea += area;
-	}
-
-	if (NE != nullptr) {
-		width = NE->lowRight.first - NE->upLeft.first + 1;
-		height = NE->lowRight.second - NE->upLeft.second + 1;
-		area = width * height;
-		
-		red += (NE->avg.r * area);
-		green += (NE->avg.g * area);
-		blue += (NE->avg.b * area);
-		totalArea += area;
-	}
-
-	if (SW != nullptr) {
-		width = SW->lowRight.first - SW->upLeft.first + 1;
-		height = SW->lowRight.second - SW->upLeft.second + 1;
-		area = width * height;
-		
-		red += (SW->avg.r * area);
-		green += (SW->avg.g * area);
-		blue += (SW->avg.b * area);
-		totalArea += area;
-	}
-
-	if (SE != nullptr) {
-		width = SE->lowRight.first - SE->upLeft.first + 1;
-		height = SE->lowRight.second - SE->upLeft.second + 1;
-		area = width * height;
-		
-		red += (SE->avg.r * area);
-		green += (SE->avg.g * area);
-		blue += (SE->avg.b * area);
-		totalArea += area;
-	}
-
-	red = red / totalArea;
-	green = green / totalArea;
-	blue = blue / totalArea;
-
-	RGBAPixel a = RGBAPixel(red, green, blue);
-	return a;
+/**
+ * @file qtree.cpp
+ * @description student implementation of QTree class used for storing image data
+ *              CPSC 221 PA3
+ *
+ *              SUBMIT THIS FILE
+ */
+
+#include "qtree.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <cmath>
+
+/**
+ * Constructor that builds a QTree out of the given PNG.
+ * Every leaf in the tree corresponds to a pixel in the PNG.
+ * Every non-leaf node corresponds to a rectangle of pixels
+ * in the original PNG, represented by an (x,y) pair for the
+ * upper left corner of the rectangle and an (x,y) pair for
+ * lower right corner of the rectangle. In addition, the Node
+ * stores a pixel representing the average color over the
+ * rectangle.
+ *
+ * The average color for each node in your implementation MUST
+ * be determined in constant time. HINT: this will lead to nodes
+ * at shallower levels of the tree to accumulate some error in their
+ * average color value, but we will accept this consequence in
+ * exchange for faster tree construction.
+ * Note that we will be looking for specific color values in our
+ * autograder, so if you instead perform a slow but accurate
+ * average color computation, you will likely fail the test cases!
+ *
+ * Every node's children correspond to a partition of the
+ * node's rectangle into (up to) four smaller rectangles. The node's
+ * rectangle is split evenly (or as close to evenly as possible)
+ * along both horizontal and vertical axes. If an even split along
+ * the vertical axis is not possible, the extra line will be included
+ * in the left side; If an even split along the horizontal axis is not
+ * possible, the extra line will be included in the upper side.
+ * If a single-pixel-wide rectangle needs to be split, the NE and SE children
+ * will be null; likewise if a single-pixel-tall rectangle needs to be split,
+ * the SW and SE children will be null.
+ *
+ * In this way, each of the children's rectangles together will have coordinates
+ * that when combined, completely cover the original rectangle's image
+ * region and do not overlap.
+ */
+QTree::QTree(const PNG& imIn) {
+	height = imIn.height();
+	width = imIn.width();
+	pair<unsigned int, unsigned int> ul = {0,0};
+	pair<unsigned int, unsigned int> lr = {width-1, height-1};
+	map<pair<unsigned int, unsigned int>, size_t> memo;
+	arena.Reserve(NodeCount(width, height, memo));
+	root = BuildNode(imIn, ul,lr);
+	AverageLevels(root);
+}
+
+/**
+ * Parallel version of the constructor above; builds exactly the same
+ * tree. Every quadrant whose rectangle holds at least cutoff pixels is
+ * built as a separate task on pool, and a node's average is computed
+ * only once all of its quadrants have been joined. Each subtree is
+ * placed in its own precomputed range of the node arena, so tasks
+ * never share an allocation cursor.
+ *
+ * @param imIn image to decompose.
+ * @param pool work-stealing pool that runs the quadrant tasks.
+ * @param cutoff minimum pixel count of a quadrant that gets its own task.
+ */
+QTree::QTree(const PNG& imIn, TaskPool& pool, unsigned int cutoff) {
+	height = imIn.height();
+	width = imIn.width();
+	pair<unsigned int, unsigned int> ul = {0,0};
+	pair<unsigned int, unsigned int> lr = {width-1, height-1};
+	map<pair<unsigned int, unsigned int>, size_t> counts;
+	size_t total = NodeCount(width, height, counts);
+	arena.Reserve(total);
+	root = nullptr;
+	if (total > 0) {
+		root = BuildNode(imIn, ul, lr, arena.Claim(total), pool, cutoff, counts);
+	}
+}
+
+/**
+ * Builds the same tree as QTree(const PNG&) from a packed image,
+ * converting each pixel as PackedPNG::toPNG would. The input needs
+ * 4 bytes per pixel rather than a PNG's 16, and is never unpacked
+ * as a whole.
+ *
+ * @param imIn image to decompose.
+ */
+QTree::QTree(const PackedPNG& imIn) {
+	height = imIn.height();
+	width = imIn.width();
+	pair<unsigned int, unsigned int> ul = {0,0};
+	pair<unsigned int, unsigned int> lr = {width-1, height-1};
+	map<pair<unsigned int, unsigned int>, size_t> memo;
+	arena.Reserve(NodeCount(width, height, memo));
+	root = BuildNode(imIn, ul, lr);
+	AverageLevels(root);
+}
+
+/**
+ * Builds the same tree as QTree(const PNG&), visiting the image in
+ * the given order. BuildOrder::BottomUp does not recurse: it creates
+ * the leaves in a single row-major pass over the image and then
+ * forms each level of parents from the level below, one row at a
+ * time, applying the same uneven split rule as the recursive build.
+ *
+ * @param imIn image to decompose.
+ * @param order whether to build top-down or bottom-up.
+ */
+QTree::QTree(const PNG& imIn, BuildOrder order) {
+	height = imIn.height();
+	width = imIn.width();
+	map<pair<unsigned int, unsigned int>, size_t> memo;
+	arena.Reserve(NodeCount(width, height, memo));
+	if (order == BuildOrder::BottomUp) {
+		root = BuildBottomUp(imIn);
+	} else {
+		pair<unsigned int, unsigned int> ul = {0,0};
+		pair<unsigned int, unsigned int> lr = {width-1, height-1};
+		root = BuildNode(imIn, ul, lr);
+		AverageLevels(root);
+	}
+}
+
+/**
+ * Builds the same decomposition as QTree(const PNG&), with internal
+ * node averages computed according to mode. In AverageMode::Exact
+ * each internal node stores the true mean colour of its rectangle
+ * (each channel truncated to an integer), found in constant time from
+ * a summed-area table built in one pass over the image. The table is
+ * kept with the tree so that Variance and PruneByVariance can be used.
+ *
+ * @param imIn image to decompose.
+ * @param mode how internal node averages are computed.
+ */
+QTree::QTree(const PNG& imIn, AverageMode mode) {
+	height = imIn.height();
+	width = imIn.width();
+	pair<unsigned int, unsigned int> ul = {0,0};
+	pair<unsigned int, unsigned int> lr = {width-1, height-1};
+	map<pair<unsigned int, unsigned int>, size_t> memo;
+	arena.Reserve(NodeCount(width, height, memo));
+	root = BuildNode(imIn, ul, lr);
+	AverageLevels(root);
+	if (mode == AverageMode::Exact) {
+		stats = make_shared<const SummedAreaTable>(imIn);
+		ExactAverages(root);
+	}
+}
+
+/**
+ * Overloaded assignment operator for QTrees.
+ * Part of the Big Three that we must define because the class
+ * allocates dynamic memory. This depends on your implementation
+ * of the copy and clear funtions.
+ *
+ * @param rhs The right hand side of the assignment statement.
+ */
+QTree& QTree::operator=(const QTree& rhs) {
+	// ADD YOUR IMPLEMENTATION BELOW
+	if (this != &rhs) {
+		// this and rhs are not the same object in memory
+		Clear();
+		Copy(rhs);
+	}
+	return *this;
+}
+
+/**
+ * Move constructor for a QTree. Takes over the nodes of other in
+ * constant time, leaving other an empty tree.
+ *
+ * @param other The QTree we are moving from.
+ */
+QTree::QTree(QTree&& other) noexcept {
+	root = nullptr;
+	width = 0;
+	height = 0;
+	swap(other);
+}
+
+/**
+ * Move assignment operator. Frees this tree and takes over the nodes
+ * of rhs in constant time, leaving rhs an empty tree.
+ *
+ * @param rhs The right hand side of the assignment statement.
+ */
+QTree& QTree::operator=(QTree&& rhs) noexcept {
+	if (this != &rhs) {
+		Clear();
+		width = 0;
+		height = 0;
+		swap(rhs);
+	}
+	return *this;
+}
+
+/**
+ * Exchanges the contents of this tree and other in constant time.
+ * The arenas trade blocks, so every node pointer stays valid.
+ *
+ * @param other The QTree to exchange with.
+ */
+void QTree::swap(QTree& other) noexcept {
+	std::swap(root, other.root);
+	std::swap(width, other.width);
+	std::swap(height, other.height);
+	arena.Swap(other.arena);
+	stats.swap(other.stats);
+	pruneThresholds.swap(other.pruneThresholds);
+}
+
+/**
+ * Exchanges the contents of two QTrees in constant time.
+ */
+void swap(QTree& a, QTree& b) noexcept {
+	a.swap(b);
+}
+
+/**
+ * Render returns a PNG image consisting of the pixels
+ * stored in the tree. may be used on pruned trees. Draws
+ * every leaf node's rectangle onto a PNG canvas using the
+ * average color stored in the node.
+ *
+ * For up-scaled images, no color interpolation will be done;
+ * each rectangle is fully rendered into a larger rectangular region.
+ *
+ * @param scale multiplier for each horizontal/vertical dimension
+ * @pre scale > 0
+ */
+PNG QTree::Render(unsigned int scale) const {
+	PNG rendered = PNG(width*scale, height*scale);
+	Render(scale,rendered,root);
+	return rendered;
+}
+
+
+void QTree::Render(unsigned int scale, PNG& img, Node* nd) const {
+	if (nd == NULL) {
+		return ;
+	}
+
+	if (nd->SE == NULL && nd->NE == NULL && nd->SW == NULL && nd->NW == NULL) {
+		Paint(scale, img, nd);
+	}
+
+	Render(scale, img, nd->SE);
+	Render(scale, img, nd->NE);
+	Render(scale, img, nd->SW);
+	Render(scale, img, nd->NW);
+	
+	return ;
+}
+
+/**
+ * Renders the tree as Prune(tolerance) would leave it, without
+ * pruning or copying it: a node whose prune threshold is within
+ * tolerance is drawn as a leaf. Any number of tolerances can be
+ * rendered from the same annotated tree; if AnnotatePruneThresholds
+ * has not been called, the thresholds are computed for this call only.
+ *
+ * @param scale multiplier for each horizontal/vertical dimension
+ * @param tolerance maximum RGBA distance to qualify for pruning
+ * @pre scale > 0
+ * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+ */
+PNG QTree::Render(unsigned int scale, double tolerance) const {
+	PNG rendered = PNG(width*scale, height*scale);
+	if (pruneThresholds.size() == arena.Size()) {
+		Render(scale, rendered, root, tolerance, pruneThresholds);
+	} else {
+		vector<double> thresholds;
+		ComputePruneThresholds(thresholds);
+		Render(scale, rendered, root, tolerance, thresholds);
+	}
+	return rendered;
+}
+
+void QTree::Render(unsigned int scale, PNG& img, Node* nd, double tolerance, const vector<double>& thresholds) const {
+	if (nd == NULL) {
+		return;
+	}
+
+	// Prune keeps a node whole exactly when its threshold is within tolerance
+	if ((nd->SE == NULL && nd->NE == NULL && nd->SW == NULL && nd->NW == NULL)
+		|| thresholds[arena.Index(nd)] <= tolerance) {
+		Paint(scale, img, nd);
+		return;
+	}
+
+	Render(scale, img, nd->SE, tolerance, thresholds);
+	Render(scale, img, nd->NE, tolerance, thresholds);
+	Render(scale, img, nd->SW, tolerance, thresholds);
+	Render(scale, img, nd->NW, tolerance, thresholds);
+}
+
+/**
+ * Parallel version of Render; produces exactly the same image. Leaf
+ * rectangles never overlap, so every subtree whose scaled rectangle
+ * covers at least cutoff output pixels is painted as a separate task
+ * on pool. May be used on pruned trees.
+ *
+ * @param scale multiplier for each horizontal/vertical dimension
+ * @param pool work-stealing pool that runs the subtree tasks.
+ * @param cutoff minimum output pixel count of a subtree that gets its own task.
+ * @pre scale > 0
+ */
+PNG QTree::Render(unsigned int scale, TaskPool& pool, unsigned int cutoff) const {
+	PNG rendered = PNG(width*scale, height*scale);
+	if (root != nullptr) {
+		Render(scale, rendered, root, pool, cutoff);
+	}
+	return rendered;
+}
+
+void QTree::Render(unsigned int scale, PNG& img, Node* nd, TaskPool& pool, unsigned int cutoff) const {
+	if (nd->SE == NULL && nd->NE == NULL && nd->SW == NULL && nd->NW == NULL) {
+		Paint(scale, img, nd);
+		return;
+	}
+
+	TaskGroup group;
+	Node* children[4] = {nd->NW, nd->NE, nd->SW, nd->SE};
+	for (int i = 0; i < 4; i++) {
+		Node* child = children[i];
+		if (child == nullptr) {
+			continue;
+		}
+		if (NodeArea(child) * scale * scale >= cutoff) {
+			pool.Submit(group, [this, scale, &img, child, &pool, cutoff] {
+				Render(scale, img, child, pool, cutoff);
+			});
+		} else {
+			Render(scale, img, child);
+		}
+	}
+	pool.Wait(group);
+}
+
+/**
+ * Renders a coarser version of the tree without pruning or copying it:
+ * traversal stops at depth maxDepth (the root is at depth 0) and paints
+ * the average colour stored in each node it stops at. The cost is the
+ * number of nodes at or above that depth. May be used on pruned trees.
+ *
+ * @param scale multiplier for each horizontal/vertical dimension
+ * @param maxDepth deepest level of the tree to draw.
+ * @pre scale > 0
+ */
+PNG QTree::RenderToDepth(unsigned int scale, unsigned int maxDepth) const {
+	PNG rendered = PNG(width*scale, height*scale);
+	RenderLevel(scale, rendered, root, 0, maxDepth, 0);
+	return rendered;
+}
+
+/**
+ * Renders a coarser version of the tree without pruning or copying it:
+ * a node is painted with its average colour instead of being split when
+ * any of its children would be drawn less than minSize output pixels
+ * wide or tall. May be used on pruned trees.
+ *
+ * @param scale multiplier for each horizontal/vertical dimension
+ * @param minSize smallest width and height, in output pixels, of a drawn node below the root.
+ * @pre scale > 0
+ */
+PNG QTree::RenderMinNodeSize(unsigned int scale, unsigned int minSize) const {
+	PNG rendered = PNG(width*scale, height*scale);
+	RenderLevel(scale, rendered, root, 0, UINT_MAX, minSize);
+	return rendered;
+}
+
+/**
+ * Draws the subtree at nd, stopping at maxDepth or at nodes whose
+ * children would be smaller than minSize output pixels.
+ * @param depth depth of nd in the tree.
+ */
+void QTree::RenderLevel(unsigned int scale, PNG& img, Node* nd, unsigned int depth, unsigned int maxDepth, unsigned int minSize) const {
+	if (nd == NULL) {
+		return;
+	}
+
+	Node* children[4] = {nd->NW, nd->NE, nd->SW, nd->SE};
+	bool stop = depth >= maxDepth;
+	bool leaf = true;
+	for (int i = 0; i < 4; i++) {
+		Node* child = children[i];
+		if (child == NULL) {
+			continue;
+		}
+		leaf = false;
+		if ((child->lowRight.first - child->upLeft.first + 1) * scale < minSize
+			|| (child->lowRight.second - child->upLeft.second + 1) * scale < minSize) {
+			stop = true;
+		}
+	}
+
+	if (leaf || stop) {
+		Paint(scale, img, nd);
+		return;
+	}
+
+	for (int i = 0; i < 4; i++) {
+		RenderLevel(scale, img, children[i], depth + 1, maxDepth, minSize);
+	}
+}
+
+/**
+ * Renders the tree at arbitrary target dimensions, smaller or larger
+ * than the image and not necessarily in proportion. Output pixel (X, Y)
+ * takes its colour from a node containing the source point under its
+ * centre; when downscaling, a node that lands on a single output pixel
+ * is drawn with its own average instead of being split further, so each
+ * pixel shows the coarsest node covering it and the cost follows the
+ * output size rather than the tree size. Integer upscales match
+ * Render(scale). May be used on pruned trees.
+ *
+ * @param w width of the rendered image.
+ * @param h height of the rendered image.
+ * @pre w > 0, h > 0
+ */
+PNG QTree::RenderResized(unsigned int w, unsigned int h) const {
+	PNG rendered = PNG(w, h);
+	ResizedSpans(root, w, h, [&rendered](unsigned int left, unsigned int top, unsigned int span, unsigned int rows, const RGBAPixel& color) {
+		rendered.fill(left, top, span, rows, color);
+	});
+	return rendered;
+}
+
+/**
+ * Renders the tree at w x h, exactly as RenderResized does, straight
+ * into a caller-owned RGBA8 buffer instead of a new PNG. Each pixel is
+ * four bytes in red, green, blue, alpha order, with alpha scaled to
+ * [0, 255] the way PNG::writeToFile does. Nothing is allocated.
+ *
+ * @param pixels first byte of the top row of the buffer.
+ * @param w width of the buffer in pixels.
+ * @param h height of the buffer in pixels.
+ * @param stride distance in bytes from the start of one row to the next.
+ * @pre w > 0, h > 0, stride >= 4 * w
+ */
+void QTree::RenderInto(unsigned char* pixels, unsigned int w, unsigned int h, size_t stride) const {
+	ResizedSpans(root, w, h, [pixels, stride](unsigned int left, unsigned int top, unsigned int span, unsigned int rows, const RGBAPixel& color) {
+		FillBytes(pixels, stride, left, top, span, rows, color);
+	});
+}
+
+/**
+ * Renders the tree as Render(scale) does, straight into a packed RGBA8
+ * image, so no RGBAPixel canvas is ever allocated.
+ *
+ * @param scale multiplier for each horizontal/vertical dimension
+ * @pre scale > 0
+ */
+PackedPNG QTree::RenderPacked(unsigned int scale) const {
+	PackedPNG rendered(width*scale, height*scale);
+	RenderInto(rendered.data(), rendered.width(), rendered.height(), 4 * (size_t) rendered.width());
+	return rendered;
+}
+
+/**
+ * Reports the rectangle of w x h output pixels drawn by each node that
+ * RenderResized paints, together with the node's colour.
+ */
+void QTree::ResizedSpans(Node* nd, unsigned int w, unsigned int h, const function<void(unsigned int, unsigned int, unsigned int, unsigned int, const RGBAPixel&)>& fill) const {
+	if (nd == NULL) {
+		return;
+	}
+
+	// output pixels whose centres fall inside the node
+	unsigned int left = TargetStart(nd->upLeft.first, width, w);
+	unsigned int right = TargetStart(nd->lowRight.first + 1, width, w);
+	unsigned int top = TargetStart(nd->upLeft.second, height, h);
+	unsigned int bottom = TargetStart(nd->lowRight.second + 1, height, h);
+	if (left >= right || top >= bottom) {
+		return;
+	}
+
+	bool leaf = nd->SE == NULL && nd->NE == NULL && nd->SW == NULL && nd->NW == NULL;
+	if (leaf || (right - left == 1 && bottom - top == 1)) {
+		fill(left, top, right - left, bottom - top, nd->avg);
+		return;
+	}
+
+	ResizedSpans(nd->SE, w, h, fill);
+	ResizedSpans(nd->NE, w, h, fill);
+	ResizedSpans(nd->SW, w, h, fill);
+	ResizedSpans(nd->NW, w, h, fill);
+}
+
+/**
+ * First output coordinate whose pixel centre maps to source coordinate
+ * x or beyond, when source pixels are stretched onto target pixels.
+ * Output coordinate X samples source coordinate
+ * floor((X + 1/2) * source / target); this inverts that in integers.
+ */
+unsigned int QTree::TargetStart(unsigned int x, unsigned int source, unsigned int target) {
+	uint64_t scaled = 2 * (uint64_t) x * target;
+	if (scaled <= source) {
+		return 0;
+	}
+	return (unsigned int) ((scaled - source + 2 * (uint64_t) source - 1) / (2 * (uint64_t) source));
+}
+
+/**
+ * Fills the scaled rectangle of nd with its average colour.
+ */
+void QTree::Paint(unsigned int scale, PNG& img, Node* nd) const {
+	img.fill(nd->upLeft.first * scale, nd->upLeft.second * scale,
+		(nd->lowRight.first - nd->upLeft.first + 1) * scale,
+		(nd->lowRight.second - nd->upLeft.second + 1) * scale, nd->avg);
+}
+
+/**
+ * Fills a rectangle of an RGBA8 buffer with one colour, replicating the
+ * first row by doubling memcpys and copying it into every other row.
+ * @param left, top upper left corner of the rectangle.
+ * @param span, rows width and height of the rectangle.
+ */
+void QTree::FillBytes(unsigned char* pixels, size_t stride, unsigned int left, unsigned int top, unsigned int span, unsigned int rows, const RGBAPixel& color) {
+	unsigned char* first = pixels + top * stride + 4 * (size_t) left;
+	first[0] = color.r;
+	first[1] = color.g;
+	first[2] = color.b;
+	first[3] = color.a * 255;
+	size_t bytes = 4 * (size_t) span;
+	for (size_t filled = 4; filled < bytes; filled *= 2) {
+		memcpy(first + filled, first, min(filled, bytes - filled));
+	}
+	for (unsigned int y = 1; y < rows; y++) {
+		memcpy(first + y * stride, first, bytes);
+	}
+}
+
+/**
+ * Renders only the given rectangle of the scaled image, in scaled
+ * output coordinates; the result is the corresponding crop of
+ * Render(scale). Only nodes that overlap the viewport are visited, so
+ * the cost follows the visible leaves rather than the whole image.
+ * May be used on pruned trees. A viewport reaching past the image is
+ * clipped to it; one that is inverted (lr above or left of ul) or lies
+ * entirely outside the image gives an empty PNG.
+ *
+ * @param scale multiplier for each horizontal/vertical dimension
+ * @param ul upper left pixel of the viewport in the scaled image.
+ * @param lr lower right pixel of the viewport in the scaled image.
+ * @pre scale > 0
+ */
+PNG QTree::Render(unsigned int scale, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const {
+	size_t scaledWidth = (size_t)width * scale;
+	size_t scaledHeight = (size_t)height * scale;
+	if (ul.first > lr.first || ul.second > lr.second || ul.first >= scaledWidth || ul.second >= scaledHeight) {
+		return PNG();
+	}
+	lr.first = (unsigned int)min((size_t)lr.first, scaledWidth - 1);
+	lr.second = (unsigned int)min((size_t)lr.second, scaledHeight - 1);
+
+	PNG rendered = PNG(lr.first - ul.first + 1, lr.second - ul.second + 1);
+	Render(scale, rendered, root, ul, lr);
+	return rendered;
+}
+
+void QTree::Render(unsigned int scale, PNG& img, Node* nd, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const {
+	if (nd == NULL) {
+		return;
+	}
+
+	// clip the node's scaled rectangle to the viewport
+	unsigned int left = max(nd->upLeft.first * scale, ul.first);
+	unsigned int top = max(nd->upLeft.second * scale, ul.second);
+	unsigned int right = min((nd->lowRight.first + 1) * scale - 1, lr.first);
+	unsigned int bottom = min((nd->lowRight.second + 1) * scale - 1, lr.second);
+	if (left > right || top > bottom) {
+		return;
+	}
+
+	if (nd->SE == NULL && nd->NE == NULL && nd->SW == NULL && nd->NW == NULL) {
+		img.fill(left - ul.first, top - ul.second, right - left + 1, bottom - top + 1, nd->avg);
+		return;
+	}
+
+	Render(scale, img, nd->SE, ul, lr);
+	Render(scale, img, nd->NE, ul, lr);
+	Render(scale, img, nd->SW, ul, lr);
+	Render(scale, img, nd->NW, ul, lr);
+}
+
+/**
+ *  Prune function trims subtrees as high as possible in the tree.
+ *  A subtree is pruned (cleared) if all of the subtree's leaves are within
+ *  tolerance of the average color stored in the root of the subtree.
+ *  NOTE - you may use the distanceTo function found in RGBAPixel.h
+ *  Pruning criteria should be evaluated on the original tree, not
+ *  on any pruned subtree. (we only expect that trees would be pruned once.)
+ *
+ * You may want a recursive helper function for this one.
+ *
+ * @param tolerance maximum RGBA distance to qualify for pruning
+ * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+ */
+void QTree::Prune(double tolerance) {
+	// ADD YOUR IMPLEMENTATION BELOW
+	if (root == nullptr) {
+		return;
+	}
+	vector<LeafBounds> bounds(arena.Size());
+	SummarizeLeaves(root, bounds);
+	Prune(root, tolerance, bounds);
+	pruneThresholds.clear();
+}
+
+void QTree::Prune(Node * node, double tolerance, const vector<LeafBounds>& bounds) {
+	if (node == NULL) {
+		return;
+	}
+	bool withinTolerance = WithinTolerance(node, tolerance, bounds);
+
+	if (withinTolerance) {
+		// the detached nodes are reclaimed with the rest of the arena
+		node->SE = nullptr;
+		node->SW = nullptr;
+		node->NW = nullptr;
+		node->NE = nullptr;
+		return;
+	} 
+
+	Prune(node->NW, tolerance, bounds);
+	Prune(node->NE, tolerance, bounds);
+	Prune(node->SW, tolerance, bounds);
+	Prune(node->SE, tolerance, bounds);
+	return;
+}
+
+/**
+ * Parallel version of Prune; produces exactly the same pruned tree.
+ * Once a node is kept, its children are independent, so every child
+ * subtree covering at least cutoff pixels is pruned as a separate task
+ * on pool (as is the leaf-bounds pass that precedes it). Collapsed
+ * subtrees are only detached; their nodes stay in the arena, so
+ * concurrent pruning never contends on the allocator.
+ *
+ * @param tolerance maximum RGBA distance to qualify for pruning
+ * @param pool work-stealing pool that runs the subtree tasks.
+ * @param cutoff minimum pixel count of a subtree that gets its own task.
+ * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+ */
+void QTree::Prune(double tolerance, TaskPool& pool, unsigned int cutoff) {
+	if (root == nullptr) {
+		return;
+	}
+	vector<LeafBounds> bounds(arena.Size());
+	SummarizeLeaves(root, bounds, pool, cutoff);
+	Prune(root, tolerance, bounds, pool, cutoff);
+	pruneThresholds.clear();
+}
+
+void QTree::Prune(Node* node, double tolerance, const vector<LeafBounds>& bounds, TaskPool& pool, unsigned int cutoff) {
+	if (WithinTolerance(node, tolerance, bounds)) {
+		// the detached nodes are reclaimed with the rest of the arena
+		node->SE = nullptr;
+		node->SW = nullptr;
+		node->NW = nullptr;
+		node->NE = nullptr;
+		return;
+	}
+
+	TaskGroup group;
+	Node* children[4] = {node->NW, node->NE, node->SW, node->SE};
+	for (int i = 0; i < 4; i++) {
+		Node* child = children[i];
+		if (child == nullptr) {
+			continue;
+		}
+		if (NodeArea(child) >= cutoff) {
+			pool.Submit(group, [this, child, tolerance, &bounds, &pool, cutoff] {
+				Prune(child, tolerance, bounds, pool, cutoff);
+			});
+		} else {
+			Prune(child, tolerance, bounds);
+		}
+	}
+	pool.Wait(group);
+}
+
+/**
+ * Fills in the leaf bounds of every node below nd in one post-order
+ * pass. Bounds are indexed by arena slot.
+ * @param nd root of the subtree to summarize.
+ * @param bounds one entry per arena slot.
+ */
+void QTree::SummarizeLeaves(Node* nd, vector<LeafBounds>& bounds) const {
+	Node* children[4] = {nd->NW, nd->NE, nd->SW, nd->SE};
+
+	if (children[0] == nullptr && children[1] == nullptr && children[2] == nullptr && children[3] == nullptr) {
+		bounds[arena.Index(nd)] = LeafBoundsOf(nd->avg);
+		return;
+	}
+
+	for (int i = 0; i < 4; i++) {
+		if (children[i] != nullptr) {
+			SummarizeLeaves(children[i], bounds);
+		}
+	}
+	MergeLeafBounds(nd, bounds);
+}
+
+/**
+ * Sets the leaf bounds of an internal node to the union of the bounds
+ * of its children, which must already be filled in.
+ * @param nd internal node to update.
+ * @param bounds one entry per arena slot.
+ */
+void QTree::MergeLeafBounds(Node* nd, vector<LeafBounds>& bounds) const {
+	LeafBounds& b = bounds[arena.Index(nd)];
+	Node* children[4] = {nd->NW, nd->NE, nd->SW, nd->SE};
+
+	bool first = true;
+	for (int i = 0; i < 4; i++) {
+		if (children[i] == nullptr) {
+			continue;
+		}
+		const LeafBounds& child = bounds[arena.Index(children[i])];
+		if (first) {
+			b = child;
+		} else {
+			IncludeBounds(b, child);
+		}
+		first = false;
+	}
+}
+
+/**
+ * Parallel version of SummarizeLeaves. Child subtrees covering at least
+ * cutoff pixels are summarized as separate tasks; each task writes only
+ * the bounds of its own subtree.
+ * @param nd root of the subtree to summarize.
+ * @param bounds one entry per arena slot.
+ * @param pool pool that runs the subtree tasks.
+ * @param cutoff minimum pixel count of a subtree that gets its own task.
+ */
+void QTree::SummarizeLeaves(Node* nd, vector<LeafBounds>& bounds, TaskPool& pool, unsigned int cutoff) {
+	Node* children[4] = {nd->NW, nd->NE, nd->SW, nd->SE};
+
+	TaskGroup group;
+	bool leaf = true;
+	for (int i = 0; i < 4; i++) {
+		Node* child = children[i];
+		if (child == nullptr) {
+			continue;
+		}
+		leaf = false;
+		if (NodeArea(child) >= cutoff) {
+			pool.Submit(group, [this, child, &bounds, &pool, cutoff] {
+				SummarizeLeaves(child, bounds, pool, cutoff);
+			});
+		} else {
+			SummarizeLeaves(child, bounds);
+		}
+	}
+	pool.Wait(group);
+
+	if (leaf) {
+		SummarizeLeaves(nd, bounds);
+	} else {
+		MergeLeafBounds(nd, bounds);
+	}
+}
+
+/**
+ * Number of pixels in the rectangle of a node.
+ */
+size_t QTree::NodeArea(const Node* nd) {
+	return (size_t)(nd->lowRight.first - nd->upLeft.first + 1) * (nd->lowRight.second - nd->upLeft.second + 1);
+}
+
+/**
+ * Decides whether every leaf below nd is within tolerance of nd's average,
+ * with the same result as GetChildren. The answer is no if the bounds
+ * already place some leaf beyond tolerance, and yes if they place every
+ * leaf within it; only the cases in between walk the leaves.
+ * @param nd root of the subtree to test.
+ * @param tolerance maximum RGBA distance to qualify for pruning.
+ * @param bounds leaf bounds filled in by SummarizeLeaves.
+ */
+bool QTree::WithinTolerance(Node* nd, double tolerance, const vector<LeafBounds>& bounds) {
+	const LeafBounds& b = bounds[arena.Index(nd)];
+	if (LeafDistanceFloor(b, nd->avg) > tolerance) {
+		return false;
+	}
+	if (LeafDistanceCeiling(b, nd->avg) <= tolerance) {
+		return true;
+	}
+	return GetChildren(nd, nd->avg, tolerance);
+}
+
+/**
+ * Exact colour variance of a rectangle of the original image, summed
+ * over the red, green and blue channels, in constant time. Pruning
+ * heuristics can use this as the true error of collapsing a node.
+ *
+ * @param ul upper left corner of the rectangle.
+ * @param lr lower right corner of the rectangle.
+ * @pre the tree was built with AverageMode::Exact and has not been
+ *      flipped or rotated.
+ */
+double QTree::Variance(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const {
+	if (stats == nullptr) {
+		cerr << "ERROR: QTree::Variance() called on a tree not built with AverageMode::Exact." << endl;
+		return 0;
+	}
+	return stats->Variance(ul, lr);
+}
+
+/**
+ * Prunes every subtree, as high in the tree as possible, whose
+ * rectangle has a colour variance of at most maxVariance.
+ *
+ * @param maxVariance largest variance (see Variance) of a collapsed node.
+ * @pre the tree was built with AverageMode::Exact and has not been
+ *      flipped or rotated.
+ */
+void QTree::PruneByVariance(double maxVariance) {
+	if (stats == nullptr) {
+		cerr << "ERROR: QTree::PruneByVariance() called on a tree not built with AverageMode::Exact." << endl;
+		return;
+	}
+	PruneByVariance(root, maxVariance);
+	pruneThresholds.clear();
+}
+
+void QTree::PruneByVariance(Node* nd, double maxVariance) {
+	if (nd == nullptr) {
+		return;
+	}
+
+	if (stats->Variance(nd->upLeft, nd->lowRight) <= maxVariance) {
+		// the detached nodes are reclaimed with the rest of the arena
+		nd->NW = nullptr;
+		nd->NE = nullptr;
+		nd->SW = nullptr;
+		nd->SE = nullptr;
+		return;
+	}
+
+	PruneByVariance(nd->NW, maxVariance);
+	PruneByVariance(nd->NE, maxVariance);
+	PruneByVariance(nd->SW, maxVariance);
+	PruneByVariance(nd->SE, maxVariance);
+}
+
+/**
+ * Records, for every node, the smallest tolerance at which Prune
+ * would collapse it: the largest distance from the node's average
+ * to any leaf below it. Lets the functions below pick a tolerance
+ * without pruning anything.
+ * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+ */
+void QTree::AnnotatePruneThresholds() {
+	ComputePruneThresholds(pruneThresholds);
+}
+
+/**
+ * Computes the prune threshold of every node, indexed by arena slot.
+ * One post-order pass gathers the leaf bounds of every subtree; each
+ * node's farthest leaf is then found by MaxLeafDistance, which uses
+ * those bounds to skip the subtrees that cannot hold it.
+ * @param thresholds receives one threshold per arena slot.
+ */
+void QTree::ComputePruneThresholds(vector<double>& thresholds) const {
+	thresholds.assign(arena.Size(), 0);
+	if (root == nullptr) {
+		return;
+	}
+	vector<LeafBounds> bounds(arena.Size());
+	SummarizeLeaves(root, bounds);
+	ComputePruneThresholds(root, bounds, thresholds);
+}
+
+void QTree::ComputePruneThresholds(Node* nd, const vector<LeafBounds>& bounds, vector<double>& thresholds) const {
+	Node* children[4] = {nd->NW, nd->NE, nd->SW, nd->SE};
+	if (children[0] == nullptr && children[1] == nullptr && children[2] == nullptr && children[3] == nullptr) {
+		return;
+	}
+	thresholds[arena.Index(nd)] = MaxLeafDistance(nd, nd->avg, bounds, 0);
+	for (int i = 0; i < 4; i++) {
+		if (children[i] != nullptr) {
+			ComputePruneThresholds(children[i], bounds, thresholds);
+		}
+	}
+}
+
+/**
+ * Largest distance from avg to a leaf of the subtree rooted at nd, as
+ * measured by GetChildren, or best if that is larger. Children are
+ * searched from the largest distance ceiling down, and a subtree whose
+ * ceiling is no more than the best distance so far is skipped; the
+ * ceilings are upper bounds, so the result is still exact.
+ * @param nd root of the subtree to search.
+ * @param avg colour to measure from.
+ * @param bounds leaf bounds filled in by SummarizeLeaves.
+ * @param best largest distance found so far.
+ */
+double QTree::MaxLeafDistance(Node* nd, RGBAPixel avg, const vector<LeafBounds>& bounds, double best) const {
+	Node* children[4] = {nd->NW, nd->NE, nd->SW, nd->SE};
+	if (children[0] == nullptr && children[1] == nullptr && children[2] == nullptr && children[3] == nullptr) {
+		return max(best, avg.distanceTo(nd->avg));
+	}
+
+	pair<double, Node*> order[4];
+	int count = 0;
+	for (int i = 0; i < 4; i++) {
+		if (children[i] != nullptr) {
+			order[count++] = {LeafDistanceCeiling(bounds[arena.Index(children[i])], avg), children[i]};
+		}
+	}
+	sort(order, order + count, [](const pair<double, Node*>& a, const pair<double, Node*>& b) {
+		return a.first > b.first;
+	});
+
+	for (int i = 0; i < count; i++) {
+		if (order[i].first <= best) {
+			break;
+		}
+		best = MaxLeafDistance(order[i].second, avg, bounds, best);
+	}
+	return best;
+}
+
+/**
+ * Smallest tolerance for which Prune(tolerance) leaves at most the
+ * given number of leaves, found with one sort of the thresholds.
+ * If no tolerance gets that low, returns the one that collapses the
+ * whole tree. Uses the annotated thresholds, or computes them for this
+ * call only if AnnotatePruneThresholds has not been called.
+ * @param leaves largest acceptable leaf count.
+ * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+ */
+double QTree::ToleranceForLeafCount(unsigned int leaves) const {
+	vector<pair<double, int>> leafEvents;
+	vector<pair<double, int>> nodeEvents;
+	CollectPruneEvents(leafEvents, nodeEvents);
+	return SmallestTolerance(leafEvents, 0, leaves);
+}
+
+/**
+ * Smallest tolerance for which the tree left by Prune(tolerance)
+ * takes at most the given number of bytes, counting sizeof(Node)
+ * per remaining node. If no tolerance gets that low, returns the one
+ * that collapses the whole tree. Uses the annotated thresholds, or
+ * computes them for this call only if AnnotatePruneThresholds has not
+ * been called.
+ * @param bytes node storage budget.
+ * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+ */
+double QTree::ToleranceForByteBudget(size_t bytes) const {
+	vector<pair<double, int>> leafEvents;
+	vector<pair<double, int>> nodeEvents;
+	CollectPruneEvents(leafEvents, nodeEvents);
+	return SmallestTolerance(nodeEvents, CountNodes(), bytes / sizeof(Node));
+}
+
+/**
+ * Prunes the tree with the smallest tolerance that leaves at most
+ * the given number of leaves.
+ * @param leaves largest acceptable leaf count.
+ * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+ */
+void QTree::PruneToLeafCount(unsigned int leaves) {
+	Prune(ToleranceForLeafCount(leaves));
+}
+
+/**
+ * Prunes the tree with the smallest tolerance whose remaining nodes
+ * fit in the given number of bytes.
+ * @param bytes node storage budget.
+ * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+ */
+void QTree::PruneToByteBudget(size_t bytes) {
+	Prune(ToleranceForByteBudget(bytes));
+}
+
+/**
+ * Turns the thresholds of the whole tree into counting events: the
+ * annotated thresholds if they are current, or else ones computed here.
+ * @param leafEvents changes to the leaf count.
+ * @param nodeEvents changes to the node count.
+ */
+void QTree::CollectPruneEvents(vector<pair<double, int>>& leafEvents, vector<pair<double, int>>& nodeEvents) const {
+	if (root == nullptr) {
+		return;
+	}
+	if (pruneThresholds.size() == arena.Size()) {
+		CollectPruneEvents(root, HUGE_VAL, pruneThresholds, leafEvents, nodeEvents);
+	} else {
+		vector<double> thresholds;
+		ComputePruneThresholds(thresholds);
+		CollectPruneEvents(root, HUGE_VAL, thresholds, leafEvents, nodeEvents);
+	}
+}
+
+/**
+ * Turns the thresholds of the subtree at nd into counting events.
+ *
+ * A node survives Prune(tolerance) while tolerance is below the threshold
+ * of every ancestor (survives, the smallest of them), and it is a leaf
+ * of the pruned tree once tolerance also reaches its own threshold. So
+ * it adds a leaf on [threshold, survives) and a node on [0, survives).
+ * Events are (tolerance, change in count) pairs.
+ * @param nd root of the subtree.
+ * @param survives smallest threshold over the strict ancestors of nd.
+ * @param thresholds prune threshold of every node, by arena slot.
+ * @param leafEvents changes to the leaf count.
+ * @param nodeEvents changes to the node count.
+ */
+void QTree::CollectPruneEvents(Node* nd, double survives, const vector<double>& thresholds, vector<pair<double, int>>& leafEvents, vector<pair<double, int>>& nodeEvents) const {
+	if (nd == nullptr) {
+		return;
+	}
+	double threshold = thresholds[arena.Index(nd)];
+
+	if (survives != HUGE_VAL) {
+		nodeEvents.push_back({survives, -1});
+	}
+	if (threshold < survives) {
+		leafEvents.push_back({threshold, 1});
+		if (survives != HUGE_VAL) {
+			leafEvents.push_back({survives, -1});
+		}
+	}
+
+	double below = min(survives, threshold);
+	CollectPruneEvents(nd->NW, below, thresholds, leafEvents, nodeEvents);
+	CollectPruneEvents(nd->NE, below, thresholds, leafEvents, nodeEvents);
+	CollectPruneEvents(nd->SW, below, thresholds, leafEvents, nodeEvents);
+	CollectPruneEvents(nd->SE, below, thresholds, leafEvents, nodeEvents);
+}
+
+/**
+ * Sweeps sorted counting events upwards from tolerance 0 and returns the
+ * first tolerance at which the count is at most target, or the largest
+ * event tolerance if it never gets there.
+ * @param events (tolerance, change in count) pairs; sorted in place.
+ * @param count count below every event.
+ * @param target largest acceptable count.
+ */
+double QTree::SmallestTolerance(vector<pair<double, int>>& events, long count, long target) {
+	sort(events.begin(), events.end());
+
+	double tolerance = 0;
+	size_t i = 0;
+	while (true) {
+		while (i < events.size() && events[i].first <= tolerance) {
+			count += events[i].second;
+			i++;
+		}
+		if (count <= target || i == events.size()) {
+			return tolerance;
+		}
+		tolerance = events[i].first;
+	}
+}
+
+bool QTree::GetChildren(Node * root, RGBAPixel avg, double tolerance) {
+	if (root == NULL) {
+		return true;
+	}
+
+	if (root->SE == NULL && root->NE == NULL && root->SW == NULL && root->NW == NULL) {
+		if (avg.distanceTo(root->avg) > tolerance) {
+	 		return false;
+	 	}
+	}
+
+	bool within = true;
+
+	within = GetChildren(root->SE, avg, tolerance);
+	if (!within) {
+		return within;
+	}
+
+	within = GetChildren(root->SW, avg, tolerance);
+
+	if (!within) {
+		return within;
+	}
+	within = GetChildren(root->NE, avg, tolerance);
+
+	if (!within) {
+		return within;
+	}
+	within = GetChildren(root->NW, avg, tolerance);
+
+	if (!within) {
+		return within;
+	}
+
+	return within;
+}
+
+
+/**
+ *  FlipHorizontal rearranges the contents of the tree, so that
+ *  its rendered image will appear mirrored across a vertical axis.
+ *  This may be called on a previously pruned/flipped/rotated tree.
+ *
+ *  After flipping, the NW/NE/SW/SE pointers must map to what will be
+ *  physically rendered in the respective NW/NE/SW/SE corners, but it
+ *  is no longer necessary to ensure that 1-pixel wide rectangles have
+ *  null eastern children
+ *  (i.e. after flipping, a node's NW and SW pointers may be null, but
+ *  have non-null NE and SE)
+ * 
+ *  You may want a recursive helper function for this one.
+ */
+void QTree::FlipHorizontal() {
+	root = FlipHorizontal(root);
+	
+}
+
+
+Node* QTree::FlipHorizontal(Node *nd) {
+	if (nd == nullptr) {
+		return nullptr;
+	}
+	Node* NW = nd->NW;
+	Node* NE = nd->NE;
+	Node* SW = nd->SW;
+	Node* SE = nd->SE;
+	pair<unsigned int, unsigned int> NW_ul, NW_lr;
+	pair<unsigned int, unsigned int> NE_lr;
+	pair<unsigned int, unsigned int> SW_ul;
+	pair<unsigned int, unsigned int> SE_ul, SE_lr;
+	
+
+
+	if (nd->NE != NULL) {
+		NE_lr = {nd->upLeft.first + NE->lowRight.first - NE->upLeft.first, NE->lowRight.second};
+		nd->NE->upLeft = nd->upLeft;
+		nd->NE->lowRight = NE_lr;
+	}
+	if (nd->NW != NULL) {
+		unsigned int NE_w = 0;
+		if (NE != NULL) {
+			NE_w = NE->lowRight.first - NE->upLeft.first + 1;
+		}
+		NW_ul = {nd->upLeft.first + NE_w, nd->upLeft.second};
+		NW_lr = {nd->lowRight.first, NW->lowRight.second};
+		nd->NW->upLeft = NW_ul;
+		nd->NW->lowRight = NW_lr;
+
+	}
+	if (nd->SE != NULL) {
+		SE_ul = {nd->upLeft.first, SE->upLeft.second};
+		SE_lr = {nd->upLeft.first + SE->lowRight.first - SE->upLeft.first, SE->lowRight.second};
+		nd->SE->upLeft = SE_ul;
+		nd->SE->lowRight = SE_lr;
+	}
+	if (nd->SW != NULL) {
+		unsigned int SE_w = 0;
+		if (SE != NULL) {
+			SE_w = SE->lowRight.first - SE->upLeft.first + 1;
+		}
+		SW_ul = {nd->upLeft.first + SE_w, SW->upLeft.second};
+		nd->SW->upLeft = SW_ul;
+		nd->SW->lowRight = nd->lowRight;
+	}
+	std::swap(nd->NW,nd->NE);
+	std::swap(nd->SW,nd->SE);
+	Node* old_NW = nd->NW;
+	Node* old_NE = nd->NE;
+	Node* old_SW = nd->SW;
+	Node* old_SE = nd->SE;
+	nd->NE = FlipHorizontal(old_NE);
+	nd->NW = FlipHorizontal(old_NW);
+	nd->SW = FlipHorizontal(old_SW);
+	nd->SE = FlipHorizontal(old_SE);
+	return nd;
+}
+
+
+/**
+ *  RotateCCW rearranges the contents of the tree, so that its
+ *  rendered image will appear rotated by 90 degrees counter-clockwise.
+ *  This may be called on a previously pruned/flipped/rotated tree.
+ *
+ *  Note that this may alter the dimensions of the rendered image, relative
+ *  to its original dimensions.
+ *
+ *  After rotation, the NW/NE/SW/SE pointers must map to what will be
+ *  physically rendered in the respective NW/NE/SW/SE corners, but it
+ *  is no longer necessary to ensure that 1-pixel tall or wide rectangles
+ *  have null eastern or southern children
+ *  (i.e. after rotation, a node's NW and NE pointers may be null, but have
+ *  non-null SW and SE, or it may have null NW/SW but non-null NE/SE)
+ *
+ *  You may want a recursive helper function for this one.
+ */
+// void QTree::RotateCCW() {
+//     // recalculate width / height
+//     // unsigned int temp = width;
+//     // width = height; 
+//     // height = temp;
+//     root = RotateCCW(root, root->upLeft);
+// 	// width = root->lowRight.first + 1;
+// 	// height = root->lowRight.second + 1;
+// 	width = 200;
+// 	height = 200;
+// }
+
+// Node* QTree::RotateCCW(Node* nd, pair<unsigned int, unsigned int> parent_ul) {
+//     if (nd == NULL) {
+//      return nd;
+//     }
+// 	nd->upLeft = parent_ul;
+
+//     Node* NW = nd->NW;
+//     Node* NE = nd->NE;
+//     Node* SW = nd->SW;
+//     Node* SE = nd->SE;
+
+//     pair<unsigned int, unsigned int> NW_ul, NW_lr;
+//     pair<unsigned int, unsigned int> NE_ul, NE_lr;
+//     pair<unsigned int, unsigned int> SW_ul, SW_lr;
+//     pair<unsigned int, unsigned int> SE_ul, SE_lr;
+// 	// unsigned int nw_x = nd->upLeft.first, ne_x = nd->upLeft.first, sw_x = nd->upLeft.first, se_x = nd->upLeft.first;
+// 	// unsigned int nw_y = nd->upLeft.second, ne_y = nd->upLeft.second, sw_y = nd->upLeft.second, se_y = nd->upLeft.second;
+// 	pair<unsigned int, unsigned int> nw, ne, sw, se = nd->upLeft;
+
+//     if (NE != NULL) {
+//      NE_ul = nd->upLeft;
+//      NE_lr = {nd->upLeft.first + NE->lowRight.second - NE->upLeft.second, nd->upLeft.second + NE->lowRight.first - NE->upLeft.first};
+//      nd->NE->upLeft = NE_ul;
+//      nd->NE->lowRight = NE_lr;
+//     }
+//     if (SE != NULL) {
+//      unsigned int NE_w = 0;
+//      if (NE != NULL) {
+//          NE_w = NE->lowRight.second - NE->upLeft.second + 1;
+//      }
+//      SE_ul = {nd->upLeft.first + NE_w, nd->upLeft.second};
+//      SE_lr = {nd->upLeft.first + SE->lowRight.second - SE->upLeft.second + NE_w, nd->upLeft.second + SE->lowRight.first - SE->upLeft.first};
+//      nd->SE->upLeft = SE_ul;
+//      nd->SE->lowRight = SE_lr;
+//     }
+//     if (NW != NULL) {
+//      unsigned int NE_h = 0;
+//      if (NE != NULL || SE != NULL) {
+// 		if (NE != NULL) {
+// 			NE_h = NE->lowRight.first - NE->upLeft.first + 1;
+// 		} else {
+// 			NE_h = SE->lowRight.first - SE->upLeft.first + 1;
+// 		}
+//      } 
+//      NW_ul = {nd->upLeft.first, nd->upLeft.second + NE_h};
+//      NW_lr = {nd->upLeft.first + NW->lowRight.second - NW->upLeft.second, nd->upLeft.second + NW->lowRight.first - NW->upLeft.first + NE_h};
+
+//      nd->NW->upLeft = NW_ul;
+//      nd->NW->lowRight = NW_lr;
+//     }
+//     if (SW != NULL) {
+//      unsigned int NW_w = 0;
+//      unsigned int SE_h = 0;
+//      if (NE != NULL || SE != NULL) {
+// 		if (NE != NULL) {
+// 			SE_h = NE->lowRight.first - NE->upLeft.first + 1;
+// 		} else {
+// 			SE_h = SE->lowRight.first - SE->upLeft.first + 1;
+// 		}
+//      }
+//      if (NW != NULL) {
+//          NW_w = NW->lowRight.second - NW->upLeft.second + 1;
+//      }
+//      SW_ul = {nd->upLeft.first + NW_w, nd->upLeft.second + SE_h};
+//      SW_lr = {nd->upLeft.first + SW->lowRight.second - SW->upLeft.second + NW_w, nd->upLeft.second + SW->lowRight.first - SW->upLeft.first + SE_h};
+
+//      nd->SW->upLeft = SW_ul;
+//      nd->SW->lowRight = SW_lr;
+//     }
+// 	swap(nd->NW, nd->NE);
+// 	swap(nd->SE, nd->SW);
+// 	swap(nd->SW, nd->NE);
+
+//     Node* old_NW = nd->NW;
+//     Node* old_NE = nd->NE;
+//     Node* old_SW = nd->SW;
+//     Node* old_SE = nd->SE;
+
+// 	// if (NW != NULL) {
+// 	// 	ne_x += NW->lowRight.first - NW->upLeft.first + 1;
+// 	// }
+// 	// if (NW != NULL || NE != NULL) {
+// 	// 	sw_y = (NW != NULL) ? NW->lowRight.second - NW->upLeft.second + 1 : NE->lowRight.second - NE->upLeft.second + 1;
+// 	// 	se_y += (NW != NULL) ? NW->lowRight.second - NW->upLeft.second + 1 : NE->lowRight.second - NE->upLeft.second + 1;
+// 	// }
+// 	// if (SW != NULL) {
+// 	// 	se_x += SW->lowRight.first - SW->upLeft.first + 1;
+// 	// }
+
+// 	if (NE != NULL) {
+// 		ne = NE->upLeft;
+// 	}
+// 	if (NW != NULL) {
+// 		nw = NW->upLeft;
+// 	}
+// 	if (SW != NULL) {
+// 		sw = SW->upLeft;
+// 	}
+// 	if (SE != NULL) {
+// 		se = SE->upLeft;
+// 	}
+// 	nd->NE = RotateCCW(old_NE, ne);
+//     nd->NW = RotateCCW(old_NW, nw);
+//     nd->SW = RotateCCW(old_SW, sw);
+//     nd->SE = RotateCCW(old_SE, se);
+//     return nd;
+// }
+
+
+
+
+/**
+ *  RotateCCW rearranges the contents of the tree, so that its
+ *  rendered image will appear rotated by 90 degrees counter-clockwise.
+ *  This may be called on a previously pruned/flipped/rotated tree.
+ *
+ *  Note that this may alter the dimensions of the rendered image, relative
+ *  to its original dimensions.
+ *
+ *  After rotation, the NW/NE/SW/SE pointers must map to what will be
+ *  physically rendered in the respective NW/NE/SW/SE corners, but it
+ *  is no longer necessary to ensure that 1-pixel tall or wide rectangles
+ *  have null eastern or southern children
+ *  (i.e. after rotation, a node's NW and NE pointers may be null, but have
+ *  non-null SW and SE, or it may have null NW/SW but non-null NE/SE)
+ *
+ *  You may want a recursive helper function for this one.
+ */
+void QTree::RotateCCW() {
+	// ADD YOUR IMPLEMENTATION BELOW
+	if (root != NULL) {
+		pair<unsigned int, unsigned int> newLR = {root->lowRight.second, root->lowRight.first};
+		root->lowRight = newLR;
+	}
+	root = Rotate(root);
+	unsigned int temp = height;
+	height = width;
+	width = temp;
+	
+}
+
+Node* QTree::Rotate(Node * node) {
+	if (node == NULL) {
+		return nullptr;
+	}
+
+	vector<Node*> temp = {node->NW, node->NE, node->SW, node->SE};
+
+	node->NW = temp[1];
+	node->NE = temp[3];
+	node->SW = temp[0];
+	node->SE = temp[2];
+
+	int NW_W = 0;
+	int NW_H = 0;
+	pair<unsigned int, unsigned int> NW_UL;
+	pair<unsigned int, unsigned int> NW_LR;
+
+	pair<unsigned int, unsigned int> NE_UL;
+	int NE_W;
+	int NE_H;
+	pair<unsigned int, unsigned int> NE_LR;
+
+	pair<unsigned int, unsigned int> SW_UL;
+	int SW_W = 0;
+	int SW_H = 0;
+	pair<unsigned int, unsigned int> SW_LR;
+
+	pair<unsigned int, unsigned int> SE_UL;
+	int SE_W;
+	int SE_H;
+	pair<unsigned int, unsigned int> SE_LR;
+
+
+	if (node->NW != NULL) {
+		NW_UL = node->upLeft;
+		NW_W = temp[1]->lowRight.first - temp[1]->upLeft.first;
+		NW_H = temp[1]->lowRight.second - temp[1]->upLeft.second;
+		NW_LR = {NW_UL.first + NW_H, NW_UL.second + NW_W};
+	}
+
+	if (node->NE != NULL) {
+		NE_UL = node->upLeft;
+		if (node->NW != NULL) {
+			NE_UL = {NW_UL.first + NW_H + 1, NW_UL.second};
+		}
+		NE_W = temp[3]->lowRight.first - temp[3]->upLeft.first;
+		NE_H = temp[3]->lowRight.second - temp[3]->upLeft.second;
+		NE_LR = {NE_UL.first + NE_H, NE_UL.second + NE_W};
+	}
+
+	if (node->SW != NULL) {
+		SW_UL = node->upLeft;
+		if (node->NW != NULL) {
+			SW_UL = {NW_UL.first, NW_UL.second + NW_W + 1};
+		}
+		SW_W = temp[0]->lowRight.first - temp[0]->upLeft.first;
+		SW_H = temp[0]->lowRight.second - temp[0]->upLeft.second;
+		SW_LR = {SW_UL.first + SW_H, SW_UL.second + SW_W};
+	}
+	
+	if (node->SE != NULL) {
+		SE_UL = node->upLeft;
+		if (node->SW != NULL) {
+			SE_UL = {SW_UL.first + SW_H + 1, SW_UL.second};
+		} else if (node->NE != NULL) {
+			SE_UL = {NE_UL.first, NE_UL.second + NE_W + 1};
+		}
+		SE_W = temp[2]->lowRight.first - temp[2]->upLeft.first;
+		SE_H = temp[2]->lowRight.second - temp[2]->upLeft.second;
+		SE_LR = {SE_UL.first + SE_H, SE_UL.second + SE_W};
+	}
+
+	if (node->NW != NULL) {
+		node->NW->upLeft = NW_UL;
+		node->NW->lowRight = NW_LR;
+	}
+
+	if (node->NE != NULL) {
+		node->NE->upLeft = NE_UL;
+		node->NE->lowRight = NE_LR;
+	}
+
+	if (node->SW != NULL) {
+		node->SW->upLeft = SW_UL;
+		node->SW->lowRight = SW_LR;
+	}
+
+	if (node->SE != NULL) {
+		node->SE->upLeft = SE_UL;
+		node->SE->lowRight = SE_LR;
+	}
+
+
+	node->NW = Rotate(node->NW);
+	node->NE = Rotate(node->NE);
+	node->SE = Rotate(node->SE);
+	node->SW = Rotate(node->SW);
+
+	return node;
+}
+
+// pair<unsigned int, unsigned int> QTree::CalcNewBounds(Node *nd, pair<unsigned int, unsigned int> parent_ul) {
+// 	int nd_width = nd->lowRight.first - nd->upLeft.first + 1;
+// 	int nd_height = nd->lowRight.second - nd->upLeft.second + 1;
+// 	int diff = nd_width - nd_height;
+// 	unsigned int nd_x = nd->upLeft.first;
+// 	unsigned int nd_y = nd->upLeft.second;
+
+// 	if (nd_width == nd_height) {
+// 		return nd->upLeft;
+// 	}
+// 	if (nd->upLeft.first != parent_ul.first) {
+// 		if (nd_height > nd_width) {
+// 			nd_x = nd->upLeft.first + abs(diff);
+// 		} else {
+// 			nd_x = nd->upLeft.first - abs(diff);
+// 		}
+// 	}
+// 	if (nd->upLeft.second != parent_ul.second) {
+// 		if (nd_height > nd_width) {
+// 			nd_y = nd->upLeft.second - abs(diff);
+// 		} else {
+// 			nd_y = nd->upLeft.second + abs(diff);
+// 		}
+// 	}
+// 	pair<unsigned int, unsigned int> res = {nd_x, nd_y};
+// 	return res;
+// }
+
+/**
+ * Destroys all dynamically allocated memory associated with the
+ * current QTree object. Complete for PA3.
+ * Every node lives in the arena, so this is a single deallocation.
+ */
+void QTree::Clear() {
+	// ADD YOUR IMPLEMENTATION BELOW
+	arena.Release();
+	stats.reset();
+	pruneThresholds.clear();
+	root = nullptr;
+}
+
+/**
+ * Copies the parameter other QTree into the current QTree.
+ * Does not free any memory. Called by copy constructor and operator=.
+ * The other tree's arena is copied in one pass and the root is rebased
+ * onto the copy, so no tree walk or per-node allocation takes place.
+ * @param other The QTree to be copied.
+ */
+void QTree::Copy(const QTree& other) {
+	// ADD YOUR IMPLEMENTATION BELOW
+	arena.CopyFrom(other.arena);
+	root = arena.Rebase(other.arena, other.root);
+	stats = other.stats;
+	pruneThresholds = other.pruneThresholds;
+	width = other.width;
+	height = other.height;
+}
+
+/**
+ * Private helper function for the constructor. Recursively builds
+ * the tree according to the specification of the constructor.
+ * Leaves get their pixel; internal node averages are left for
+ * AverageLevels, which computes them a whole level at a time.
+ * @param img reference to the original input image.
+ * @param ul upper left point of current node's rectangle.
+ * @param lr lower right point of current node's rectangle.
+ */
+Node* QTree::BuildNode(const PNG& img, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) {
+	// Replace the line below with your implementation
+	int x = lr.first + 1 - ul.first;
+	int y = lr.second + 1 - ul.second;
+
+	if (x == 0 || y == 0) {
+		return NULL;
+	}
+	
+	Node* nd = arena.Allocate(ul, lr, RGBAPixel());
+
+	if (x == 1 && y == 1) {
+		nd->avg = *img.pixelAt(ul.first, ul.second);
+		return nd;
+	}
+	
+	Quadrants q = SplitQuadrants(ul, lr);
+	Node** children[4] = {&nd->NW, &nd->NE, &nd->SW, &nd->SE};
+	for (int i = 0; i < 4; i++) {
+		if (q.present[i]) {
+			*children[i] = BuildNode(img, q.ul[i], q.lr[i]);
+		}
+	}
+
+	return nd;
+}
+
+/**
+ * Packed version of BuildNode above; leaves get their pixel unpacked.
+ * @param img reference to the original input image.
+ * @param ul upper left point of current node's rectangle.
+ * @param lr lower right point of current node's rectangle.
+ */
+Node* QTree::BuildNode(const PackedPNG& img, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) {
+	if (lr.first + 1 == ul.first || lr.second + 1 == ul.second) {
+		return nullptr;
+	}
+
+	Node* nd = arena.Allocate(ul, lr, RGBAPixel());
+
+	if (ul == lr) {
+		nd->avg = img.pixelAt(ul.first, ul.second)->toRGBAPixel();
+		return nd;
+	}
+
+	Quadrants q = SplitQuadrants(ul, lr);
+	Node** children[4] = {&nd->NW, &nd->NE, &nd->SW, &nd->SE};
+	for (int i = 0; i < 4; i++) {
+		if (q.present[i]) {
+			*children[i] = BuildNode(img, q.ul[i], q.lr[i]);
+		}
+	}
+
+	return nd;
+}
+
+/**
+ * Private helper function for the bottom-up constructor.
+ *
+ * Splitting the image top-down splits each axis independently, so the
+ * rectangles at depth k of the tree are exactly the products of the
+ * column spans and row spans at depth k of SplitLevels. At the deepest
+ * level every span is a single line, and that level is the pixel grid.
+ * Each shallower level is then formed from the one below it, row by row:
+ * a cell that is a single pixel is the leaf carried up from below, and
+ * any other cell becomes a node whose children are the cells its spans
+ * split into (NE/SE missing for one-pixel-wide cells, SW/SE missing for
+ * one-pixel-tall cells, as in BuildNode).
+ *
+ * @param img reference to the original input image.
+ * @return the root of the tree.
+ */
+Node* QTree::BuildBottomUp(const PNG& img) {
+	if (width == 0 || height == 0) {
+		return nullptr;
+	}
+
+	vector<vector<pair<unsigned int, unsigned int>>> cols = SplitLevels(width);
+	vector<vector<pair<unsigned int, unsigned int>>> rows = SplitLevels(height);
+	while (cols.size() < rows.size()) {
+		cols.push_back(cols.back());
+	}
+	while (rows.size() < cols.size()) {
+		rows.push_back(rows.back());
+	}
+	size_t depth = cols.size() - 1;
+
+	// deepest level: one leaf per pixel, read in row-major order
+	vector<Node*> below(width * height);
+	for (unsigned int y = 0; y < height; y++) {
+		const RGBAPixel* pixels = img.row(y);
+		for (unsigned int x = 0; x < width; x++) {
+			below[y * width + x] = arena.Allocate({x, y}, {x, y}, pixels[x]);
+		}
+	}
+
+	SiblingBatch batch;
+	for (size_t level = depth; level-- > 0; ) {
+		const vector<pair<unsigned int, unsigned int>>& levelCols = cols[level];
+		const vector<pair<unsigned int, unsigned int>>& levelRows = rows[level];
+		size_t belowWidth = cols[level + 1].size();
+
+		// index of the first child span of each span on this level
+		vector<size_t> firstCol(levelCols.size());
+		for (size_t i = 0, next = 0; i < levelCols.size(); i++) {
+			firstCol[i] = next;
+			next += (levelCols[i].second > 1) ? 2 : 1;
+		}
+
+		vector<Node*> current(levelCols.size() * levelRows.size());
+		vector<Node*> parents;
+		size_t rowChild = 0;
+		for (size_t j = 0; j < levelRows.size(); j++) {
+			pair<unsigned int, unsigned int> span_y = levelRows[j];
+			Node** north = &below[rowChild * belowWidth];
+			Node** south = (span_y.second > 1) ? north + belowWidth : nullptr;
+			parents.clear();
+
+			for (size_t i = 0; i < levelCols.size(); i++) {
+				pair<unsigned int, unsigned int> span_x = levelCols[i];
+				size_t colChild = firstCol[i];
+				bool east = span_x.second > 1;
+
+				if (!east && south == nullptr) {
+					current[j * levelCols.size() + i] = north[colChild];
+					continue;
+				}
+
+				pair<unsigned int, unsigned int> ul = {span_x.first, span_y.first};
+				pair<unsigned int, unsigned int> lr = {span_x.first + span_x.second - 1, span_y.first + span_y.second - 1};
+				Node* nd = arena.Allocate(ul, lr, RGBAPixel());
+				nd->NW = north[colChild];
+				if (east) {
+					nd->NE = north[colChild + 1];
+				}
+				if (south != nullptr) {
+					nd->SW = south[colChild];
+				}
+				if (east && south != nullptr) {
+					nd->SE = south[colChild + 1];
+				}
+				parents.push_back(nd);
+				current[j * levelCols.size() + i] = nd;
+			}
+
+			// average the whole row of new parents at once
+			AverageParents(parents, batch);
+
+			rowChild += (south != nullptr) ? 2 : 1;
+		}
+
+		below.swap(current);
+	}
+
+	return below[0];
+}
+
+/**
+ * Sets the average of every parent from its children's averages, all
+ * in one SiblingBatch.
+ * @param parents internal nodes whose children already have averages.
+ * @param batch scratch batch, reused between calls.
+ */
+void QTree::AverageParents(const vector<Node*>& parents, SiblingBatch& batch) {
+	batch.Reset(parents.size());
+	for (size_t p = 0; p < parents.size(); p++) {
+		Node* children[4] = {parents[p]->NW, parents[p]->NE, parents[p]->SW, parents[p]->SE};
+		for (unsigned int slot = 0; slot < 4; slot++) {
+			if (children[slot] != nullptr) {
+				batch.Set(p, slot, children[slot]->avg, (int) NodeArea(children[slot]));
+			}
+		}
+	}
+	batch.Compute();
+	for (size_t p = 0; p < parents.size(); p++) {
+		parents[p]->avg = batch.Average(p);
+	}
+}
+
+/**
+ * Computes the average of every internal node below nd, deepest level
+ * first, so that each level is averaged in one SiblingBatch once all
+ * of its children are known. Gives the same values as nodeAverage.
+ * @param nd root of a tree whose leaves already hold their pixels.
+ */
+void QTree::AverageLevels(Node* nd) {
+	if (nd == nullptr) {
+		return;
+	}
+
+	// internal nodes grouped by depth, found breadth first
+	vector<vector<Node*>> levels;
+	vector<Node*> frontier = {nd};
+	while (!frontier.empty()) {
+		vector<Node*> parents;
+		vector<Node*> next;
+		for (Node* parent : frontier) {
+			Node* children[4] = {parent->NW, parent->NE, parent->SW, parent->SE};
+			bool leaf = true;
+			for (Node* child : children) {
+				if (child != nullptr) {
+					next.push_back(child);
+					leaf = false;
+				}
+			}
+			if (!leaf) {
+				parents.push_back(parent);
+			}
+		}
+		if (!parents.empty()) {
+			levels.push_back(move(parents));
+		}
+		frontier.swap(next);
+	}
+
+	SiblingBatch batch;
+	for (size_t level = levels.size(); level-- > 0; ) {
+		AverageParents(levels[level], batch);
+	}
+}
+
+/**
+ * Replaces the average of every internal node below nd with the exact
+ * mean of its rectangle. Leaves keep their pixel.
+ * @param nd root of the subtree to update.
+ */
+void QTree::ExactAverages(Node* nd) {
+	if (nd == nullptr || (nd->NW == nullptr && nd->NE == nullptr && nd->SW == nullptr && nd->SE == nullptr)) {
+		return;
+	}
+	nd->avg = stats->Mean(nd->upLeft, nd->lowRight);
+	ExactAverages(nd->NW);
+	ExactAverages(nd->NE);
+	ExactAverages(nd->SW);
+	ExactAverages(nd->SE);
+}
+
+/**
+ * Splits [0, length) the way BuildNode splits one axis of a rectangle:
+ * every span longer than one line becomes its upper (or left) half,
+ * which keeps the extra line, followed by its lower (or right) half,
+ * and single lines are carried down unchanged. Levels are produced
+ * until every span is a single line.
+ * @param length number of lines along the axis.
+ * @return the (start, length) spans of every level, from the root down.
+ */
+vector<vector<pair<unsigned int, unsigned int>>> QTree::SplitLevels(unsigned int length) {
+	vector<vector<pair<unsigned int, unsigned int>>> levels;
+	levels.push_back({{0, length}});
+
+	bool split = length > 1;
+	while (split) {
+		split = false;
+		const vector<pair<unsigned int, unsigned int>>& above = levels.back();
+		vector<pair<unsigned int, unsigned int>> next;
+		for (size_t i = 0; i < above.size(); i++) {
+			unsigned int start = above[i].first;
+			unsigned int size = above[i].second;
+			if (size == 1) {
+				next.push_back(above[i]);
+				continue;
+			}
+			unsigned int larger = size - (size/2);
+			next.push_back({start, larger});
+			next.push_back({start + larger, size/2});
+			split = split || larger > 1;
+		}
+		levels.push_back(next);
+	}
+
+	return levels;
+}
+
+/**
+ * Private helper function for the parallel constructor. Builds the
+ * subtree for ul..lr in preorder into the arena range starting at slot,
+ * forking large quadrants onto pool and joining them before the average
+ * of the node is computed.
+ * @param img reference to the original input image.
+ * @param ul upper left point of current node's rectangle.
+ * @param lr lower right point of current node's rectangle.
+ * @param slot first arena slot of this subtree.
+ * @param pool pool that runs forked quadrants.
+ * @param cutoff minimum pixel count of a forked quadrant.
+ * @param counts node counts by rectangle size, filled in by NodeCount.
+ */
+Node* QTree::BuildNode(const PNG& img, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr, size_t slot,
+	TaskPool& pool, unsigned int cutoff, const map<pair<unsigned int, unsigned int>, size_t>& counts) {
+	unsigned int x = lr.first + 1 - ul.first;
+	unsigned int y = lr.second + 1 - ul.second;
+
+	Node* nd = arena.Construct(slot, ul, lr, RGBAPixel());
+
+	if (x == 1 && y == 1) {
+		nd->avg = *img.pixelAt(ul.first, ul.second);
+		return nd;
+	}
+
+	Quadrants q = SplitQuadrants(ul, lr);
+
+	TaskGroup group;
+	Node** children[4] = {&nd->NW, &nd->NE, &nd->SW, &nd->SE};
+	size_t childSlot = slot + 1;
+	for (int i = 0; i < 4; i++) {
+		if (!q.present[i]) {
+			continue;
+		}
+		// children follow their parent in preorder: NW, NE, SW, SE
+		pair<unsigned int, unsigned int> c_ul = q.ul[i];
+		pair<unsigned int, unsigned int> c_lr = q.lr[i];
+		Node** child = children[i];
+		size_t c_slot = childSlot;
+		childSlot += LookupNodeCount(c_lr.first + 1 - c_ul.first, c_lr.second + 1 - c_ul.second, counts);
+
+		if ((size_t) q.Area(i) >= cutoff) {
+			pool.Submit(group, [=, &pool, &counts, &img] {
+				*child = BuildNode(img, c_ul, c_lr, c_slot, pool, cutoff, counts);
+			});
+		} else {
+			*child = BuildNode(img, c_ul, c_lr, c_slot, pool, cutoff, counts);
+		}
+	}
+	pool.Wait(group);
+
+	nd->avg = nodeAverage(nd);
+
+	return nd;
+}
+
+// /*********************************************************/
+// /*** IMPLEMENT YOUR OWN PRIVATE MEMBER FUNCTIONS BELOW ***/
+// /*********************************************************/
+
+/**
+ * Number of nodes BuildNode creates for a w x h rectangle. Follows the
+ * same split rule as BuildNode, so the arena can be sized exactly before
+ * the build starts. Results are memoized by rectangle size; there are at
+ * most a few distinct sizes per level of the tree.
+ * @param w width of the rectangle.
+ * @param h height of the rectangle.
+ * @param memo previously counted rectangle sizes.
+ */
+size_t QTree::NodeCount(unsigned int w, unsigned int h, map<pair<unsigned int, unsigned int>, size_t>& memo) {
+	if (w == 0 || h == 0) {
+		return 0;
+	}
+	if (w == 1 && h == 1) {
+		return 1;
+	}
+
+	auto it = memo.find({w, h});
+	if (it != memo.end()) {
+		return it->second;
+	}
+
+	unsigned int larger_w = w - (w/2);
+	unsigned int larger_h = h - (h/2);
+
+	size_t count = 1;
+	if (w != 1 && h != 1) {
+		count += NodeCount(larger_w, larger_h, memo) + NodeCount(w/2, larger_h, memo)
+			+ NodeCount(larger_w, h/2, memo) + NodeCount(w/2, h/2, memo);
+	} else if (h == 1) {
+		count += NodeCount(larger_w, 1, memo) + NodeCount(w/2, 1, memo);
+	} else {
+		count += NodeCount(1, larger_h, memo) + NodeCount(1, h/2, memo);
+	}
+
+	memo[{w, h}] = count;
+	return count;
+}
+
+/**
+ * Number of nodes BuildNode creates for a w x h rectangle, read from a
+ * memo already filled in by NodeCount. Safe to call from several threads.
+ * @param w width of the rectangle.
+ * @param h height of the rectangle.
+ * @param memo rectangle sizes counted by NodeCount.
+ */
+size_t QTree::LookupNodeCount(unsigned int w, unsigned int h, const map<pair<unsigned int, unsigned int>, size_t>& memo) {
+	if (w == 0 || h == 0) {
+		return 0;
+	}
+	if (w == 1 && h == 1) {
+		return 1;
+	}
+	return memo.at({w, h});
+}
+
+RGBAPixel QTree::nodeAverage(Node* node) {
+	Node* children[4] = {node->NW, node->NE, node->SW, node->SE};
+	const RGBAPixel* avgs[4];
+	int area[4];
+
+	for (int i = 0; i < 4; i++) {
+		avgs[i] = nullptr;
+		area[i] = 0;
+		if (children[i] != nullptr) {
+			avgs[i] = &children[i]->avg;
+			area[i] = (children[i]->lowRight.first - children[i]->upLeft.first + 1)
+				* (children[i]->lowRight.second - children[i]->upLeft.second + 1);
+		}
+	}
+
+	return WeightedAverage(avgs, area);
 }
\ No newline at end of file
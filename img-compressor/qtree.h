@@ -1,265 +1,569 @@
-/**
- * @file qtree.h
- * @description declaration of QTree class used for storing image data
- *              CPSC 221 PA3
- *
- *              THIS FILE WILL NOT BE SUBMITTED
- */
-
-#ifndef _QTREE_H_
-#define _QTREE_H_
-
-#include <utility>
-#include "cs221util/PNG.h"
-#include "cs221util/RGBAPixel.h"
-#include <iostream>
-#include <cmath>
-
-
-
-using namespace std;
-using namespace cs221util;
-
-/**
- * Like we had for PA1, the Node class *should be* private to the tree
- * class via the principle of encapsulation -- the end user does not
- * need to know our node-based implementation details.
- * Given for PA3, and made as a public class for convenience of testing and debugging.
- */
-class Node {
-public:
-    Node(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr, RGBAPixel a); // Node constructor
-
-    pair<unsigned int, unsigned int> upLeft;   // image coordinates of upper-left corner of node's rectangular region
-    pair<unsigned int, unsigned int> lowRight; // image coordinates of lower-right corner of node's rectangular region
-    RGBAPixel avg;  // average color of node's rectangular region
-    Node* NW; // upper-left child
-    Node* NE; // upper-right child
-    Node* SW; // lower-left child
-    Node* SE; // lower-right child
-};
-
-/**
- * QTree: This is a structure used in decomposing an image
- * into rectangular regions.
- *
- * You should not remove anything from this class definition, but
- * you will find it helpful to add your own private helper functions
- * to qtree-private.h
- */
-
-class QTree {
-public:
-
-    /* =============== start of given functions ====================*/
-
-    /**
-     * QTree destructor.
-     * Destroys all of the memory associated with the
-     * current QTree. This function should ensure that
-     * memory does not leak on destruction of a QTree.
-     */
-    ~QTree();
-
-    /**
-     * Copy constructor for a QTree. GIVEN
-     * Since QTrees allocate dynamic memory (i.e., they use "new", we
-     * must define the Big Three). This depends on your implementation
-     * of the copy funtion.
-     *
-     * @param other The QTree  we are copying.
-     */
-    QTree(const QTree& other);
-
-    /**
-     * Counts the number of nodes in the tree
-     */
-    unsigned int CountNodes() const;
-
-    /**
-     * Counts the number of leaves in the tree
-     */
-    unsigned int CountLeaves() const;
-
-    /* =============== end of given functions ====================*/
-
-    /* =============== public PA3 FUNCTIONS =========================*/
-
-    /**
-     * Constructor that builds a QTree out of the given PNG.
-     * Every leaf in the tree corresponds to a pixel in the PNG.
-     * Every non-leaf node corresponds to a rectangle of pixels
-     * in the original PNG, represented by an (x,y) pair for the
-     * upper left corner of the rectangle and an (x,y) pair for
-     * lower right corner of the rectangle. In addition, the Node
-     * stores a pixel representing the average color over the
-     * rectangle.
-     * 
-     * The average color for each node in your implementation MUST
-     * be determined in constant time. HINT: this will lead to nodes
-     * at shallower levels of the tree to accumulate some error in their
-     * average color value, but we will accept this consequence in
-     * exchange for faster tree construction.
-     * Note that we will be looking for specific color values in our
-     * autograder, so if you instead perform a slow but accurate
-     * average color computation, you will likely fail the test cases!
-     *
-     * Every node's children correspond to a partition of the
-     * node's rectangle into (up to) four smaller rectangles. The node's
-     * rectangle is split evenly (or as close to evenly as possible)
-     * along both horizontal and vertical axes. If an even split along
-     * the vertical axis is not possible, the extra line will be included
-     * in the left side; If an even split along the horizontal axis is not
-     * possible, the extra line will be included in the upper side.
-     * If a single-pixel-wide rectangle needs to be split, the NE and SE children
-     * will be null; likewise if a single-pixel-tall rectangle needs to be split,
-     * the SW and SE children will be null.
-     *
-     * In this way, each of the children's rectangles together will have coordinates
-     * that when combined, completely cover the original rectangle's image
-     * region and do not overlap.
-     */
-    QTree(const PNG& imIn);
-
-    /**
-     * Overloaded assignment operator for QTrees.
-     * Part of the Big Three that we must define because the class
-     * allocates dynamic memory. This depends on your implementation
-     * of the copy and clear funtions.
-     *
-     * @param rhs The right hand side of the assignment statement.
-     */
-    QTree& operator=(const QTree& rhs);
-
-    /**
-     * Render returns a PNG image consisting of the pixels
-     * stored in the tree. may be used on pruned trees. Draws
-     * every leaf node's rectangle onto a PNG canvas using the
-     * average color stored in the node.
-     * 
-     * For up-scaled images, no color interpolation will be done;
-     * each rectangle is fully rendered into a larger rectangular region.
-     * 
-     * @param scale multiplier for each horizontal/vertical dimension
-     * @pre scale > 0
-     */
-    PNG Render(unsigned int scale) const;
-
-    /**
-     *  Prune function trims subtrees as high as possible in the tree.
-     *  A subtree is pruned (cleared) if all of the subtree's leaves are within
-     *  tolerance of the average color stored in the root of the subtree.
-     *  NOTE - you may use the distanceTo function found in RGBAPixel.h
-     *  Pruning criteria should be evaluated on the original tree, not
-     *  on any pruned subtree. (we only expect that trees would be pruned once.)
-     *
-     * You may want a recursive helper function for this one.
-     *
-     * @param tolerance maximum RGBA distance to qualify for pruning
-     * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
-     */
-    void Prune(double tolerance);
-
-    /**
-     *  FlipHorizontal rearranges the contents of the tree, so that
-     *  its rendered image will appear mirrored across a vertical axis.
-     *  This may be called on a previously pruned/flipped/rotated tree.
-     *
-     *  After flipping, the NW/NE/SW/SE pointers must map to what will be
-     *  physically rendered in the respective NW/NE/SW/SE corners, but it
-     *  is no longer necessary to ensure that 1-pixel wide rectangles have
-     *  null eastern children
-     *  (i.e. after flipping, a node's NW and SW pointers may be null, but
-     *  have non-null NE and SE)
-     *
-     *  You may want a recursive helper function for this one.
-     */
-    void FlipHorizontal();
-
-    /**
-     *  RotateCCW rearranges the contents of the tree, so that its
-     *  rendered image will appear rotated by 90 degrees counter-clockwise.
-     *  This may be called on a previously pruned/flipped/rotated tree.
-     *
-     *  Note that this may alter the dimensions of the rendered image, relative
-     *  to its original dimensions.
-     *
-     *  After rotation, the NW/NE/SW/SE pointers must map to what will be
-     *  physically rendered in the respective NW/NE/SW/SE corners, but it
-     *  is no longer necessary to ensure that 1-pixel tall or wide rectangles
-     *  have null eastern or southern children
-     *  (i.e. after rotation, a node's NW and NE pointers may be null, but have
-     *  non-null SW and SE, or it may have null NW/SW but non-null NE/SE)
-     *
-     *  You may want a recursive helper function for this one.
-     */
-    void RotateCCW();
-    /**
-    * Copies the parameter other QTree into the current QTree.
-    * Does not free any memory. Called by copy constructor and operator=.
-    * You may want a recursive helper function for this one.
-    * @param other The QTree to be copied.
-    */
-    void Copy(const QTree& other);
-
-    /* =============== end of public PA3 FUNCTIONS =========================*/
-
-private:
-    /*
-     * Private member variables.
-     *
-     * You must use these as specified in the spec and may not rename them.
-     */
-    Node* root; // pointer to the root of the QTree
-
-    unsigned int height; // height of PNG represented by the tree
-    unsigned int width; // width of PNG represented by the tree
-
-    /* =================== private PA3 functions ============== */
-
-    /**
-     * Destroys all dynamically allocated memory associated with the
-     * current QTree object. Complete for PA3.
-     * You may want a recursive helper function for this one.
-     */
-    void Clear();
-
-    // /**
-    // * Copies the parameter other QTree into the current QTree.
-    // * Does not free any memory. Called by copy constructor and operator=.
-    // * You may want a recursive helper function for this one.
-    // * @param other The QTree to be copied.
-    // */
-    // void Copy(const QTree& other);
-
-    /**
-     * Private helper function for the constructor. Recursively builds
-     * the tree according to the specification of the constructor.
-     * @param img reference to the original input image.
-     * @param ul upper left point of current node's rectangle.
-     * @param lr lower right point of current node's rectangle.
-     */
-    Node* BuildNode(const PNG& img, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr);
-
-    /**
-     * Private helper function for counting the total number of nodes in the tree. GIVEN
-     * @param nd the root of the subtree whose nodes we want to count
-     */
-    unsigned int CountNodes(Node* nd) const;
-
-    /**
-     * Private helper function for counting the number of leaves in the tree. GIVEN
-     * @param nd the root of the subtree whose leaves we want to count
-     */
-    unsigned int CountLeaves(Node* nd) const;
-
-    /* =================== end of private PA3 functions ============== */
-
-    /**
-     * If you require more private member attributes and/or private functions,
-     * declare them in qtree-private.h
-     */
-#include "qtree-private.h"
-};
-
-#endif
+/**
+ * @file qtree.h
+ * @description declaration of QTree class used for storing image data
+ *              CPSC 221 PA3
+ *
+ *              THIS FILE WILL NOT BE SUBMITTED
+ */
+
+#ifndef _QTREE_H_
+#define _QTREE_H_
+
+#include <utility>
+#include "cs221util/PNG.h"
+#include "cs221util/PackedPNG.h"
+#include "cs221util/RGBAPixel.h"
+#include "node-arena.h"
+#include "task-pool.h"
+#include "summed-area-table.h"
+#include "leaf-bounds.h"
+#include "quadrants.h"
+#include "average-kernel.h"
+#include <iostream>
+#include <cmath>
+#include <climits>
+#include <map>
+#include <memory>
+
+
+
+using namespace std;
+using namespace cs221util;
+
+/**
+ * Like we had for PA1, the Node class *should be* private to the tree
+ * class via the principle of encapsulation -- the end user does not
+ * need to know our node-based implementation details.
+ * Given for PA3, and made as a public class for convenience of testing and debugging.
+ */
+class Node {
+public:
+    Node(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr, RGBAPixel a); // Node constructor
+
+    pair<unsigned int, unsigned int> upLeft;   // image coordinates of upper-left corner of node's rectangular region
+    pair<unsigned int, unsigned int> lowRight; // image coordinates of lower-right corner of node's rectangular region
+    RGBAPixel avg;  // average color of node's rectangular region
+    Node* NW; // upper-left child
+    Node* NE; // upper-right child
+    Node* SW; // lower-left child
+    Node* SE; // lower-right child
+};
+
+/**
+ * Order in which the QTree constructor visits the image.
+ * TopDown recursively splits rectangles, as described on the constructor.
+ * BottomUp reads the image row by row and merges whole levels of nodes
+ * upwards, producing the same tree from sequential pixel accesses.
+ */
+enum class BuildOrder {
+    TopDown,
+    BottomUp
+};
+
+/**
+ * How the QTree constructor computes the average colour of internal nodes.
+ * ConstantTime combines the children's averages, as described on the
+ * constructor, and accumulates truncation error at shallow levels.
+ * Exact takes the true mean of the node's rectangle from a summed-area
+ * table of the image, and keeps the table for variance queries.
+ */
+enum class AverageMode {
+    ConstantTime,
+    Exact
+};
+
+/**
+ * QTree: This is a structure used in decomposing an image
+ * into rectangular regions.
+ *
+ * You should not remove anything from this class definition, but
+ * you will find it helpful to add your own private helper functions
+ * to qtree-private.h
+ */
+
+class QTree {
+public:
+
+    /* =============== start of given functions ====================*/
+
+    /**
+     * QTree destructor.
+     * Destroys all of the memory associated with the
+     * current QTree. This function should ensure that
+     * memory does not leak on destruction of a QTree.
+     */
+    ~QTree();
+
+    /**
+     * Copy constructor for a QTree. GIVEN
+     * Since QTrees allocate dynamic memory (i.e., they use "new", we
+     * must define the Big Three). This depends on your implementation
+     * of the copy funtion.
+     *
+     * @param other The QTree  we are copying.
+     */
+    QTree(const QTree& other);
+
+    /**
+     * Move constructor for a QTree. Takes over the nodes of other in
+     * constant time, leaving other an empty tree.
+     *
+     * @param other The QTree we are moving from.
+     */
+    QTree(QTree&& other) noexcept;
+
+    /**
+     * Counts the number of nodes in the tree
+     */
+    unsigned int CountNodes() const;
+
+    /**
+     * Counts the number of leaves in the tree
+     */
+    unsigned int CountLeaves() const;
+
+    /* =============== end of given functions ====================*/
+
+    /* =============== public PA3 FUNCTIONS =========================*/
+
+    /**
+     * Constructor that builds a QTree out of the given PNG.
+     * Every leaf in the tree corresponds to a pixel in the PNG.
+     * Every non-leaf node corresponds to a rectangle of pixels
+     * in the original PNG, represented by an (x,y) pair for the
+     * upper left corner of the rectangle and an (x,y) pair for
+     * lower right corner of the rectangle. In addition, the Node
+     * stores a pixel representing the average color over the
+     * rectangle.
+     * 
+     * The average color for each node in your implementation MUST
+     * be determined in constant time. HINT: this will lead to nodes
+     * at shallower levels of the tree to accumulate some error in their
+     * average color value, but we will accept this consequence in
+     * exchange for faster tree construction.
+     * Note that we will be looking for specific color values in our
+     * autograder, so if you instead perform a slow but accurate
+     * average color computation, you will likely fail the test cases!
+     *
+     * Every node's children correspond to a partition of the
+     * node's rectangle into (up to) four smaller rectangles. The node's
+     * rectangle is split evenly (or as close to evenly as possible)
+     * along both horizontal and vertical axes. If an even split along
+     * the vertical axis is not possible, the extra line will be included
+     * in the left side; If an even split along the horizontal axis is not
+     * possible, the extra line will be included in the upper side.
+     * If a single-pixel-wide rectangle needs to be split, the NE and SE children
+     * will be null; likewise if a single-pixel-tall rectangle needs to be split,
+     * the SW and SE children will be null.
+     *
+     * In this way, each of the children's rectangles together will have coordinates
+     * that when combined, completely cover the original rectangle's image
+     * region and do not overlap.
+     */
+    QTree(const PNG& imIn);
+
+    /**
+     * Parallel version of the constructor above; builds exactly the same
+     * tree. Every quadrant whose rectangle holds at least cutoff pixels is
+     * built as a separate task on pool, and a node's average is computed
+     * only once all of its quadrants have been joined. Each subtree is
+     * placed in its own precomputed range of the node arena, so tasks
+     * never share an allocation cursor.
+     *
+     * @param imIn image to decompose.
+     * @param pool work-stealing pool that runs the quadrant tasks.
+     * @param cutoff minimum pixel count of a quadrant that gets its own task.
+     */
+    QTree(const PNG& imIn, TaskPool& pool, unsigned int cutoff = 16384);
+
+    /**
+     * Builds the same tree as QTree(const PNG&) from a packed image,
+     * converting each pixel as PackedPNG::toPNG would. The input needs
+     * 4 bytes per pixel rather than a PNG's 16, and is never unpacked
+     * as a whole.
+     *
+     * @param imIn image to decompose.
+     */
+    QTree(const PackedPNG& imIn);
+
+    /**
+     * Builds the same tree as QTree(const PNG&), visiting the image in
+     * the given order. BuildOrder::BottomUp does not recurse: it creates
+     * the leaves in a single row-major pass over the image and then
+     * forms each level of parents from the level below, one row at a
+     * time, applying the same uneven split rule as the recursive build.
+     *
+     * @param imIn image to decompose.
+     * @param order whether to build top-down or bottom-up.
+     */
+    QTree(const PNG& imIn, BuildOrder order);
+
+    /**
+     * Builds the same decomposition as QTree(const PNG&), with internal
+     * node averages computed according to mode. In AverageMode::Exact
+     * each internal node stores the true mean colour of its rectangle
+     * (each channel truncated to an integer), found in constant time from
+     * a summed-area table built in one pass over the image. The table is
+     * kept with the tree so that Variance and PruneByVariance can be used.
+     *
+     * @param imIn image to decompose.
+     * @param mode how internal node averages are computed.
+     */
+    QTree(const PNG& imIn, AverageMode mode);
+
+    /**
+     * Overloaded assignment operator for QTrees.
+     * Part of the Big Three that we must define because the class
+     * allocates dynamic memory. This depends on your implementation
+     * of the copy and clear funtions.
+     *
+     * @param rhs The right hand side of the assignment statement.
+     */
+    QTree& operator=(const QTree& rhs);
+
+    /**
+     * Move assignment operator. Frees this tree and takes over the nodes
+     * of rhs in constant time, leaving rhs an empty tree.
+     *
+     * @param rhs The right hand side of the assignment statement.
+     */
+    QTree& operator=(QTree&& rhs) noexcept;
+
+    /**
+     * Exchanges the contents of this tree and other in constant time.
+     *
+     * @param other The QTree to exchange with.
+     */
+    void swap(QTree& other) noexcept;
+
+    /**
+     * Render returns a PNG image consisting of the pixels
+     * stored in the tree. may be used on pruned trees. Draws
+     * every leaf node's rectangle onto a PNG canvas using the
+     * average color stored in the node.
+     * 
+     * For up-scaled images, no color interpolation will be done;
+     * each rectangle is fully rendered into a larger rectangular region.
+     * 
+     * @param scale multiplier for each horizontal/vertical dimension
+     * @pre scale > 0
+     */
+    PNG Render(unsigned int scale) const;
+
+    /**
+     * Renders the tree as Prune(tolerance) would leave it, without
+     * pruning or copying it: a node whose prune threshold is within
+     * tolerance is drawn as a leaf. Any number of tolerances can be
+     * rendered from the same annotated tree; if AnnotatePruneThresholds
+     * has not been called, the thresholds are computed for this call only.
+     *
+     * @param scale multiplier for each horizontal/vertical dimension
+     * @param tolerance maximum RGBA distance to qualify for pruning
+     * @pre scale > 0
+     * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+     */
+    PNG Render(unsigned int scale, double tolerance) const;
+
+    /**
+     * Parallel version of Render; produces exactly the same image. Leaf
+     * rectangles never overlap, so every subtree whose scaled rectangle
+     * covers at least cutoff output pixels is painted as a separate task
+     * on pool. May be used on pruned trees.
+     *
+     * @param scale multiplier for each horizontal/vertical dimension
+     * @param pool work-stealing pool that runs the subtree tasks.
+     * @param cutoff minimum output pixel count of a subtree that gets its own task.
+     * @pre scale > 0
+     */
+    PNG Render(unsigned int scale, TaskPool& pool, unsigned int cutoff = 65536) const;
+
+    /**
+     * Renders only the given rectangle of the scaled image, in scaled
+     * output coordinates; the result is the corresponding crop of
+     * Render(scale). Only nodes that overlap the viewport are visited, so
+     * the cost follows the visible leaves rather than the whole image.
+     * May be used on pruned trees. A viewport reaching past the image is
+     * clipped to it; one that is inverted (lr above or left of ul) or lies
+     * entirely outside the image gives an empty PNG.
+     *
+     * @param scale multiplier for each horizontal/vertical dimension
+     * @param ul upper left pixel of the viewport in the scaled image.
+     * @param lr lower right pixel of the viewport in the scaled image.
+     * @pre scale > 0
+     */
+    PNG Render(unsigned int scale, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const;
+
+    /**
+     * Renders a coarser version of the tree without pruning or copying it:
+     * traversal stops at depth maxDepth (the root is at depth 0) and paints
+     * the average colour stored in each node it stops at. The cost is the
+     * number of nodes at or above that depth. May be used on pruned trees.
+     *
+     * @param scale multiplier for each horizontal/vertical dimension
+     * @param maxDepth deepest level of the tree to draw.
+     * @pre scale > 0
+     */
+    PNG RenderToDepth(unsigned int scale, unsigned int maxDepth) const;
+
+    /**
+     * Renders a coarser version of the tree without pruning or copying it:
+     * a node is painted with its average colour instead of being split when
+     * any of its children would be drawn less than minSize output pixels
+     * wide or tall. May be used on pruned trees.
+     *
+     * @param scale multiplier for each horizontal/vertical dimension
+     * @param minSize smallest width and height, in output pixels, of a drawn node below the root.
+     * @pre scale > 0
+     */
+    PNG RenderMinNodeSize(unsigned int scale, unsigned int minSize) const;
+
+    /**
+     * Renders the tree at arbitrary target dimensions, smaller or larger
+     * than the image and not necessarily in proportion. Output pixel (X, Y)
+     * takes its colour from a node containing the source point under its
+     * centre; when downscaling, a node that lands on a single output pixel
+     * is drawn with its own average instead of being split further, so each
+     * pixel shows the coarsest node covering it and the cost follows the
+     * output size rather than the tree size. Integer upscales match
+     * Render(scale). May be used on pruned trees.
+     *
+     * @param w width of the rendered image.
+     * @param h height of the rendered image.
+     * @pre w > 0, h > 0
+     */
+    PNG RenderResized(unsigned int w, unsigned int h) const;
+
+    /**
+     * Renders the tree at w x h, exactly as RenderResized does, straight
+     * into a caller-owned RGBA8 buffer instead of a new PNG. Each pixel is
+     * four bytes in red, green, blue, alpha order, with alpha scaled to
+     * [0, 255] the way PNG::writeToFile does. Nothing is allocated.
+     *
+     * @param pixels first byte of the top row of the buffer.
+     * @param w width of the buffer in pixels.
+     * @param h height of the buffer in pixels.
+     * @param stride distance in bytes from the start of one row to the next.
+     * @pre w > 0, h > 0, stride >= 4 * w
+     */
+    void RenderInto(unsigned char* pixels, unsigned int w, unsigned int h, size_t stride) const;
+
+    /**
+     * Renders the tree as Render(scale) does, straight into a packed RGBA8
+     * image, so no RGBAPixel canvas is ever allocated.
+     *
+     * @param scale multiplier for each horizontal/vertical dimension
+     * @pre scale > 0
+     */
+    PackedPNG RenderPacked(unsigned int scale) const;
+
+    /**
+     *  Prune function trims subtrees as high as possible in the tree.
+     *  A subtree is pruned (cleared) if all of the subtree's leaves are within
+     *  tolerance of the average color stored in the root of the subtree.
+     *  NOTE - you may use the distanceTo function found in RGBAPixel.h
+     *  Pruning criteria should be evaluated on the original tree, not
+     *  on any pruned subtree. (we only expect that trees would be pruned once.)
+     *  Pruned nodes stay in the tree's arena until the tree is cleared.
+     *
+     * You may want a recursive helper function for this one.
+     *
+     * @param tolerance maximum RGBA distance to qualify for pruning
+     * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+     */
+    void Prune(double tolerance);
+
+    /**
+     * Parallel version of Prune; produces exactly the same pruned tree.
+     * Once a node is kept, its children are independent, so every child
+     * subtree covering at least cutoff pixels is pruned as a separate task
+     * on pool (as is the leaf-bounds pass that precedes it). Collapsed
+     * subtrees are only detached; their nodes stay in the arena, so
+     * concurrent pruning never contends on the allocator.
+     *
+     * @param tolerance maximum RGBA distance to qualify for pruning
+     * @param pool work-stealing pool that runs the subtree tasks.
+     * @param cutoff minimum pixel count of a subtree that gets its own task.
+     * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+     */
+    void Prune(double tolerance, TaskPool& pool, unsigned int cutoff = 16384);
+
+    /**
+     * Exact colour variance of a rectangle of the original image, summed
+     * over the red, green and blue channels, in constant time. Pruning
+     * heuristics can use this as the true error of collapsing a node.
+     *
+     * @param ul upper left corner of the rectangle.
+     * @param lr lower right corner of the rectangle.
+     * @pre the tree was built with AverageMode::Exact and has not been
+     *      flipped or rotated.
+     */
+    double Variance(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const;
+
+    /**
+     * Prunes every subtree, as high in the tree as possible, whose
+     * rectangle has a colour variance of at most maxVariance.
+     *
+     * @param maxVariance largest variance (see Variance) of a collapsed node.
+     * @pre the tree was built with AverageMode::Exact and has not been
+     *      flipped or rotated.
+     */
+    void PruneByVariance(double maxVariance);
+
+    /**
+     * Records, for every node, the smallest tolerance at which Prune
+     * would collapse it: the largest distance from the node's average
+     * to any leaf below it. Lets the functions below pick a tolerance
+     * without pruning anything.
+     * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+     */
+    void AnnotatePruneThresholds();
+
+    /**
+     * Smallest tolerance for which Prune(tolerance) leaves at most the
+     * given number of leaves, found with one sort of the thresholds.
+     * If no tolerance gets that low, returns the one that collapses the
+     * whole tree. Uses the annotated thresholds, or computes them for this
+     * call only if AnnotatePruneThresholds has not been called.
+     * @param leaves largest acceptable leaf count.
+     * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+     */
+    double ToleranceForLeafCount(unsigned int leaves) const;
+
+    /**
+     * Smallest tolerance for which the tree left by Prune(tolerance)
+     * takes at most the given number of bytes, counting sizeof(Node)
+     * per remaining node. If no tolerance gets that low, returns the one
+     * that collapses the whole tree. Uses the annotated thresholds, or
+     * computes them for this call only if AnnotatePruneThresholds has not
+     * been called.
+     * @param bytes node storage budget.
+     * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+     */
+    double ToleranceForByteBudget(size_t bytes) const;
+
+    /**
+     * Prunes the tree with the smallest tolerance that leaves at most
+     * the given number of leaves.
+     * @param leaves largest acceptable leaf count.
+     * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+     */
+    void PruneToLeafCount(unsigned int leaves);
+
+    /**
+     * Prunes the tree with the smallest tolerance whose remaining nodes
+     * fit in the given number of bytes.
+     * @param bytes node storage budget.
+     * @pre this tree has not previously been pruned, nor is copied from a previously pruned tree.
+     */
+    void PruneToByteBudget(size_t bytes);
+
+    /**
+     *  FlipHorizontal rearranges the contents of the tree, so that
+     *  its rendered image will appear mirrored across a vertical axis.
+     *  This may be called on a previously pruned/flipped/rotated tree.
+     *
+     *  After flipping, the NW/NE/SW/SE pointers must map to what will be
+     *  physically rendered in the respective NW/NE/SW/SE corners, but it
+     *  is no longer necessary to ensure that 1-pixel wide rectangles have
+     *  null eastern children
+     *  (i.e. after flipping, a node's NW and SW pointers may be null, but
+     *  have non-null NE and SE)
+     *
+     *  You may want a recursive helper function for this one.
+     */
+    void FlipHorizontal();
+
+    /**
+     *  RotateCCW rearranges the contents of the tree, so that its
+     *  rendered image will appear rotated by 90 degrees counter-clockwise.
+     *  This may be called on a previously pruned/flipped/rotated tree.
+     *
+     *  Note that this may alter the dimensions of the rendered image, relative
+     *  to its original dimensions.
+     *
+     *  After rotation, the NW/NE/SW/SE pointers must map to what will be
+     *  physically rendered in the respective NW/NE/SW/SE corners, but it
+     *  is no longer necessary to ensure that 1-pixel tall or wide rectangles
+     *  have null eastern or southern children
+     *  (i.e. after rotation, a node's NW and NE pointers may be null, but have
+     *  non-null SW and SE, or it may have null NW/SW but non-null NE/SE)
+     *
+     *  You may want a recursive helper function for this one.
+     */
+    void RotateCCW();
+    /**
+    * Copies the parameter other QTree into the current QTree.
+    * Does not free any memory. Called by copy constructor and operator=.
+    * You may want a recursive helper function for this one.
+    * @param other The QTree to be copied.
+    */
+    void Copy(const QTree& other);
+
+    /* =============== end of public PA3 FUNCTIONS =========================*/
+
+private:
+    /*
+     * Private member variables.
+     *
+     * You must use these as specified in the spec and may not rename them.
+     */
+    Node* root; // pointer to the root of the QTree
+
+    unsigned int height; // height of PNG represented by the tree
+    unsigned int width; // width of PNG represented by the tree
+
+    /* =================== private PA3 functions ============== */
+
+    /**
+     * Destroys all dynamically allocated memory associated with the
+     * current QTree object. Complete for PA3.
+     * You may want a recursive helper function for this one.
+     */
+    void Clear();
+
+    // /**
+    // * Copies the parameter other QTree into the current QTree.
+    // * Does not free any memory. Called by copy constructor and operator=.
+    // * You may want a recursive helper function for this one.
+    // * @param other The QTree to be copied.
+    // */
+    // void Copy(const QTree& other);
+
+    /**
+     * Private helper function for the constructor. Recursively builds
+     * the tree according to the specification of the constructor.
+     * Leaves get their pixel; internal node averages are left for
+     * AverageLevels, which computes them a whole level at a time.
+     * @param img reference to the original input image.
+     * @param ul upper left point of current node's rectangle.
+     * @param lr lower right point of current node's rectangle.
+     */
+    Node* BuildNode(const PNG& img, pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr);
+
+    /**
+     * Private helper function for counting the total number of nodes in the tree. GIVEN
+     * @param nd the root of the subtree whose nodes we want to count
+     */
+    unsigned int CountNodes(Node* nd) const;
+
+    /**
+     * Private helper function for counting the number of leaves in the tree. GIVEN
+     * @param nd the root of the subtree whose leaves we want to count
+     */
+    unsigned int CountLeaves(Node* nd) const;
+
+    /* =================== end of private PA3 functions ============== */
+
+    /**
+     * If you require more private member attributes and/or private functions,
+     * declare them in qtree-private.h
+     */
+#include "qtree-private.h"
+};
+
+/**
+ * Exchanges the contents of two QTrees in constant time.
+ */
+void swap(QTree& a, QTree& b) noexcept;
+
+#endif
@@ -0,0 +1,41 @@
+/**
+ * @file quadrants.cpp
+ * @description the rule that splits a node's rectangle into its children
+ */
+
+#include "quadrants.h"
+
+/**
+ * Number of pixels in child i.
+ * @pre present[i]
+ */
+int Quadrants::Area(int i) const {
+	return (lr[i].first - ul[i].first + 1) * (lr[i].second - ul[i].second + 1);
+}
+
+/**
+ * Splits the rectangle ul..lr into its child rectangles.
+ */
+Quadrants SplitQuadrants(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) {
+	unsigned int x = lr.first + 1 - ul.first;
+	unsigned int y = lr.second + 1 - ul.second;
+	unsigned int larger_x = x - (x/2);
+	unsigned int larger_y = y - (y/2);
+
+	Quadrants q;
+	q.ul[0] = ul;
+	q.lr[0] = {ul.first + larger_x - 1, ul.second + larger_y - 1};
+	q.ul[1] = {ul.first + larger_x, ul.second};
+	q.lr[1] = {lr.first, ul.second + larger_y - 1};
+	q.ul[2] = {ul.first, ul.second + larger_y};
+	q.lr[2] = {ul.first + larger_x - 1, lr.second};
+	q.ul[3] = {ul.first + larger_x, ul.second + larger_y};
+	q.lr[3] = lr;
+
+	bool single = x == 1 && y == 1;
+	q.present[0] = !single;
+	q.present[1] = x != 1;
+	q.present[2] = y != 1;
+	q.present[3] = x != 1 && y != 1;
+	return q;
+}
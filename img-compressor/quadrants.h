@@ -0,0 +1,38 @@
+/**
+ * @file quadrants.h
+ * @description the rule that splits a node's rectangle into its children,
+ *              shared by every quadtree builder
+ */
+
+#ifndef _QUADRANTS_H_
+#define _QUADRANTS_H_
+
+#include <utility>
+
+using namespace std;
+
+/**
+ * Quadrants: the child rectangles of a node, in NW, NE, SW, SE order.
+ *
+ * The upper (or left) half of each axis keeps the extra line of an odd
+ * length. A rectangle one pixel wide has no NE or SE child and one one
+ * pixel tall has no SW or SE child; a single pixel has no children.
+ */
+struct Quadrants {
+    pair<unsigned int, unsigned int> ul[4]; // upper left corner of each child
+    pair<unsigned int, unsigned int> lr[4]; // lower right corner of each child
+    bool present[4];                        // whether each child exists
+
+    /**
+     * Number of pixels in child i.
+     * @pre present[i]
+     */
+    int Area(int i) const;
+};
+
+/**
+ * Splits the rectangle ul..lr into its child rectangles.
+ */
+Quadrants SplitQuadrants(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr);
+
+#endif
@@ -0,0 +1,113 @@
+/**
+ * @file summed-area-table.cpp
+ * @description implementation of SummedAreaTable, per-channel integral images
+ */
+
+#include <algorithm>
+#include "summed-area-table.h"
+
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 uint128; // wide enough for area * sum of squares
+#endif
+
+/**
+ * Builds the tables for the given image in one row-major pass.
+ * Entry (x, y) holds the totals over every pixel above and left of (x, y),
+ * with the channel sums wrapping modulo 2^32.
+ */
+SummedAreaTable::SummedAreaTable(const PNG& img) {
+	width = img.width();
+	height = img.height();
+	size_t entries = (size_t)(width + 1) * (height + 1);
+	sums.assign(entries, Sums());
+	squares.assign(entries, Squares());
+
+	for (unsigned int y = 0; y < height; y++) {
+		uint32_t rowSum[3] = {0, 0, 0};
+		uint64_t rowSquare[3] = {0, 0, 0};
+		const RGBAPixel* pixels = img.row(y);
+		const Sums* sumsAbove = &sums[(size_t)y * (width + 1)];
+		const Squares* squaresAbove = &squares[(size_t)y * (width + 1)];
+		Sums* sumsCurrent = &sums[(size_t)(y + 1) * (width + 1)];
+		Squares* squaresCurrent = &squares[(size_t)(y + 1) * (width + 1)];
+
+		for (unsigned int x = 0; x < width; x++) {
+			unsigned int channels[3] = {pixels[x].r, pixels[x].g, pixels[x].b};
+			for (int c = 0; c < 3; c++) {
+				rowSum[c] += channels[c];
+				rowSquare[c] += channels[c] * channels[c];
+				sumsCurrent[x + 1].sum[c] = sumsAbove[x + 1].sum[c] + rowSum[c];
+				squaresCurrent[x + 1].square[c] = squaresAbove[x + 1].square[c] + rowSquare[c];
+			}
+		}
+	}
+}
+
+/**
+ * Exact mean colour of the rectangle ul..lr, with each channel
+ * truncated to an integer. The result is opaque.
+ */
+RGBAPixel SummedAreaTable::Mean(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const {
+	Entry totals = Region(ul, lr);
+	uint64_t area = (uint64_t)(lr.first - ul.first + 1) * (lr.second - ul.second + 1);
+	return RGBAPixel(totals.sum[0] / area, totals.sum[1] / area, totals.sum[2] / area);
+}
+
+/**
+ * Population variance of the rectangle ul..lr, summed over the red,
+ * green and blue channels, in squared channel units. Each channel's
+ * area * sum of squares - sum^2 is found exactly in integers before the
+ * one division by area^2, so no precision is lost to cancellation.
+ */
+double SummedAreaTable::Variance(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const {
+	Entry totals = Region(ul, lr);
+	uint64_t area = (uint64_t)(lr.first - ul.first + 1) * (lr.second - ul.second + 1);
+
+	double variance = 0;
+	for (int c = 0; c < 3; c++) {
+#ifdef __SIZEOF_INT128__
+		uint128 spread = (uint128)area * totals.square[c] - (uint128)totals.sum[c] * totals.sum[c];
+#else
+		long double spread = (long double)area * totals.square[c] - (long double)totals.sum[c] * totals.sum[c];
+#endif
+		variance += (double)spread / ((double)area * area);
+	}
+	return variance;
+}
+
+/**
+ * Totals over the rectangle ul..lr. A rectangle of more than MaxTilePixels
+ * pixels is split into tiles small enough for the 32-bit sums, whose
+ * totals are added in 64 bits.
+ */
+SummedAreaTable::Entry SummedAreaTable::Region(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const {
+	size_t tileWidth = min((size_t)(lr.first - ul.first + 1), (size_t)MaxTilePixels);
+	size_t tileHeight = MaxTilePixels / tileWidth;
+
+	Entry totals = {};
+	for (size_t top = ul.second; top <= lr.second; top += tileHeight) {
+		size_t bottom = min(top + tileHeight - 1, (size_t)lr.second);
+		for (size_t left = ul.first; left <= lr.first; left += tileWidth) {
+			AddTile(totals, left, top, min(left + tileWidth - 1, (size_t)lr.first), bottom);
+		}
+	}
+	return totals;
+}
+
+/**
+ * Adds the totals over the rectangle from (left, top) to (right, bottom)
+ * to totals. The wrapping 32-bit channel sums give the exact sum of any
+ * rectangle of at most MaxTilePixels pixels.
+ */
+void SummedAreaTable::AddTile(Entry& totals, size_t left, size_t top, size_t right, size_t bottom) const {
+	size_t stride = width + 1;
+	size_t a = top * stride + left;
+	size_t b = top * stride + right + 1;
+	size_t c = (bottom + 1) * stride + left;
+	size_t d = (bottom + 1) * stride + right + 1;
+
+	for (int i = 0; i < 3; i++) {
+		totals.sum[i] += (uint32_t)(sums[d].sum[i] - sums[b].sum[i] - sums[c].sum[i] + sums[a].sum[i]);
+		totals.square[i] += squares[d].square[i] - squares[b].square[i] - squares[c].square[i] + squares[a].square[i];
+	}
+}
@@ -0,0 +1,94 @@
+/**
+ * @file summed-area-table.h
+ * @description declaration of SummedAreaTable, per-channel integral images
+ *              of an image and of its squared values
+ */
+
+#ifndef _SUMMED_AREA_TABLE_H_
+#define _SUMMED_AREA_TABLE_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "cs221util/PNG.h"
+#include "cs221util/RGBAPixel.h"
+
+using namespace std;
+using namespace cs221util;
+
+/**
+ * SummedAreaTable: after one pass over an image, gives the exact sum,
+ * mean and variance of the red, green and blue values over any rectangle
+ * of the image in constant time.
+ *
+ * Channel sums are kept in 32 bits and sums of squares in 64, 36 bytes
+ * per pixel. The 32-bit entries wrap on large images, but their
+ * differences are still exact over any rectangle of at most MaxTilePixels
+ * pixels, so larger rectangles are totalled one such tile at a time.
+ */
+class SummedAreaTable {
+public:
+    /**
+     * Largest rectangle totalled from one set of entries: 255 * MaxTilePixels
+     * is the largest 32-bit channel sum.
+     */
+    static const size_t MaxTilePixels = 16843009;
+
+    /**
+     * Builds the tables for the given image in one row-major pass.
+     */
+    SummedAreaTable(const PNG& img);
+
+    /**
+     * Exact mean colour of the rectangle ul..lr, with each channel
+     * truncated to an integer. The result is opaque.
+     */
+    RGBAPixel Mean(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const;
+
+    /**
+     * Population variance of the rectangle ul..lr, summed over the red,
+     * green and blue channels, in squared channel units.
+     */
+    double Variance(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const;
+
+private:
+    /**
+     * Totals over a rectangle.
+     */
+    struct Entry {
+        uint64_t sum[3];    // red, green and blue sums
+        uint64_t square[3]; // red, green and blue sums of squares
+    };
+
+    /**
+     * Running channel sums up to (but not including) one row and column.
+     */
+    struct Sums {
+        uint32_t sum[3];
+    };
+
+    /**
+     * Running sums of squares up to (but not including) one row and column.
+     */
+    struct Squares {
+        uint64_t square[3];
+    };
+
+    unsigned int width;      // width of the source image
+    unsigned int height;     // height of the source image
+    vector<Sums> sums;       // (width + 1) x (height + 1) entries, row-major
+    vector<Squares> squares; // (width + 1) x (height + 1) entries, row-major
+
+    /**
+     * Totals over the rectangle ul..lr.
+     */
+    Entry Region(pair<unsigned int, unsigned int> ul, pair<unsigned int, unsigned int> lr) const;
+
+    /**
+     * Adds the totals over the rectangle from (left, top) to (right, bottom),
+     * which has at most MaxTilePixels pixels, to totals.
+     */
+    void AddTile(Entry& totals, size_t left, size_t top, size_t right, size_t bottom) const;
+};
+
+#endif
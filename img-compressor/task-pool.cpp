@@ -0,0 +1,205 @@
+/**
+ * @file task-pool.cpp
+ * @description implementation of TaskPool, a work-stealing thread pool
+ */
+
+#include "task-pool.h"
+
+namespace {
+	// pool and deque index of the calling worker thread, if any
+	thread_local const TaskPool* currentPool = nullptr;
+	thread_local size_t currentQueue = 0;
+}
+
+TaskGroup::TaskGroup() : outstanding(0), error(nullptr) {
+}
+
+/**
+ * Whether every task submitted to this group has finished.
+ */
+bool TaskGroup::Done() const {
+	return outstanding.load(memory_order_acquire) == 0;
+}
+
+/**
+ * Starts the worker threads.
+ * @param threads number of workers, or 0 for one per hardware thread.
+ */
+TaskPool::TaskPool(unsigned int threads) : queued(0), nextQueue(0), stopping(false) {
+	if (threads == 0) {
+		threads = thread::hardware_concurrency();
+	}
+	if (threads == 0) {
+		threads = 1;
+	}
+
+	for (unsigned int i = 0; i < threads; i++) {
+		queues.push_back(unique_ptr<Queue>(new Queue()));
+	}
+	for (unsigned int i = 0; i < threads; i++) {
+		workers.push_back(thread(&TaskPool::WorkerLoop, this, i));
+	}
+}
+
+/**
+ * Stops and joins the worker threads. Queued tasks must already have
+ * been waited on.
+ */
+TaskPool::~TaskPool() {
+	{
+		lock_guard<mutex> guard(sleepLock);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (size_t i = 0; i < workers.size(); i++) {
+		workers[i].join();
+	}
+}
+
+/**
+ * Number of worker threads.
+ */
+unsigned int TaskPool::Size() const {
+	return workers.size();
+}
+
+/**
+ * Queues a task as part of group. Called from a worker, the task goes
+ * on that worker's own deque.
+ */
+void TaskPool::Submit(TaskGroup& group, function<void()> task) {
+	group.outstanding.fetch_add(1, memory_order_relaxed);
+
+	size_t target = CurrentQueue();
+	if (target == queues.size()) {
+		target = nextQueue.fetch_add(1, memory_order_relaxed) % queues.size();
+	}
+
+	{
+		// counted under the deque's lock, so queued never exceeds the tasks
+		// actually present and a woken thread always finds one
+		lock_guard<mutex> guard(queues[target]->lock);
+		queues[target]->tasks.push_back(Task{task, &group});
+		queued.fetch_add(1, memory_order_relaxed);
+	}
+	{
+		lock_guard<mutex> guard(sleepLock);
+	}
+	wake.notify_one();
+}
+
+/**
+ * Returns once every task of group has finished, running queued tasks
+ * on the calling thread in the meantime and sleeping when there are
+ * none. Rethrows the first exception thrown by a task of the group.
+ */
+void TaskPool::Wait(TaskGroup& group) {
+	while (!group.Done()) {
+		if (RunOne()) {
+			continue;
+		}
+		unique_lock<mutex> guard(sleepLock);
+		wake.wait(guard, [this, &group] { return group.Done() || queued.load(memory_order_relaxed) > 0; });
+	}
+
+	exception_ptr error;
+	{
+		lock_guard<mutex> guard(sleepLock);
+		swap(error, group.error);
+	}
+	if (error) {
+		rethrow_exception(error);
+	}
+}
+
+/**
+ * Main loop of worker self.
+ */
+void TaskPool::WorkerLoop(unsigned int self) {
+	currentPool = this;
+	currentQueue = self;
+
+	while (true) {
+		if (RunOne()) {
+			continue;
+		}
+		unique_lock<mutex> guard(sleepLock);
+		wake.wait(guard, [this] { return stopping || queued.load(memory_order_relaxed) > 0; });
+		if (stopping) {
+			return;
+		}
+	}
+}
+
+/**
+ * Runs one queued task, preferring the back of the caller's own deque
+ * and otherwise stealing from the front of another. Returns false if
+ * no task was found.
+ */
+bool TaskPool::RunOne() {
+	size_t self = CurrentQueue();
+	Task task;
+	bool found = false;
+
+	if (self < queues.size()) {
+		lock_guard<mutex> guard(queues[self]->lock);
+		if (!queues[self]->tasks.empty()) {
+			task = queues[self]->tasks.back();
+			queues[self]->tasks.pop_back();
+			queued.fetch_sub(1, memory_order_relaxed);
+			found = true;
+		}
+	}
+
+	for (size_t i = 1; !found && i <= queues.size(); i++) {
+		size_t victim = (self + i) % queues.size();
+		lock_guard<mutex> guard(queues[victim]->lock);
+		if (!queues[victim]->tasks.empty()) {
+			task = queues[victim]->tasks.front();
+			queues[victim]->tasks.pop_front();
+			queued.fetch_sub(1, memory_order_relaxed);
+			found = true;
+		}
+	}
+
+	if (!found) {
+		return false;
+	}
+
+	try {
+		task.run();
+	} catch (...) {
+		lock_guard<mutex> guard(sleepLock);
+		if (!task.group->error) {
+			task.group->error = current_exception();
+		}
+	}
+
+	// the last task of a group wakes the threads waiting on it
+	if (task.group->outstanding.fetch_sub(1, memory_order_acq_rel) == 1) {
+		WakeAll();
+	}
+	return true;
+}
+
+/**
+ * Wakes every sleeping thread. Taking sleepLock first ensures no
+ * thread is between checking its condition and going to sleep.
+ */
+void TaskPool::WakeAll() {
+	{
+		lock_guard<mutex> guard(sleepLock);
+	}
+	wake.notify_all();
+}
+
+/**
+ * Index of the calling thread's deque in this pool, or queues.size()
+ * if the caller is not one of this pool's workers.
+ */
+size_t TaskPool::CurrentQueue() const {
+	if (currentPool == this) {
+		return currentQueue;
+	}
+	return queues.size();
+}
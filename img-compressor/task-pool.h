@@ -0,0 +1,137 @@
+/**
+ * @file task-pool.h
+ * @description declaration of TaskPool, a work-stealing thread pool for
+ *              fork/join work on independent subtrees
+ */
+
+#ifndef _TASK_POOL_H_
+#define _TASK_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * TaskGroup: counts the tasks forked for one join point.
+ */
+class TaskGroup {
+public:
+    TaskGroup();
+
+    /**
+     * Whether every task submitted to this group has finished.
+     */
+    bool Done() const;
+
+private:
+    atomic<unsigned int> outstanding; // tasks submitted but not yet finished
+    exception_ptr error;              // first exception thrown by a task, guarded by the pool's sleepLock
+
+    friend class TaskPool;
+};
+
+/**
+ * TaskPool: a fixed set of worker threads, each with its own deque.
+ *
+ * A worker pushes and pops tasks at the back of its own deque and, when
+ * that is empty, steals from the front of another worker's deque. Threads
+ * that wait on a TaskGroup keep running queued tasks until the group is
+ * done, so tasks may fork and join further tasks without deadlocking, and
+ * sleep while there is nothing to run. An exception thrown by a task is
+ * rethrown by Wait once the rest of its group has finished.
+ */
+class TaskPool {
+public:
+    /**
+     * Starts the worker threads.
+     * @param threads number of workers, or 0 for one per hardware thread.
+     */
+    explicit TaskPool(unsigned int threads = 0);
+
+    /**
+     * Stops and joins the worker threads. Queued tasks must already have
+     * been waited on.
+     */
+    ~TaskPool();
+
+    /**
+     * Number of worker threads.
+     */
+    unsigned int Size() const;
+
+    /**
+     * Queues a task as part of group. Called from a worker, the task goes
+     * on that worker's own deque.
+     */
+    void Submit(TaskGroup& group, function<void()> task);
+
+    /**
+     * Returns once every task of group has finished, running queued tasks
+     * on the calling thread in the meantime and sleeping when there are
+     * none. Rethrows the first exception thrown by a task of the group.
+     */
+    void Wait(TaskGroup& group);
+
+private:
+    /**
+     * A queued task and the group it reports to.
+     */
+    struct Task {
+        function<void()> run;
+        TaskGroup* group;
+    };
+
+    /**
+     * One worker's deque.
+     */
+    struct Queue {
+        mutex lock;
+        deque<Task> tasks;
+    };
+
+    vector<unique_ptr<Queue>> queues; // one deque per worker
+    vector<thread> workers;
+
+    mutex sleepLock;                // guards idle threads going to sleep
+    condition_variable wake;        // signalled when a task is queued, a group finishes, or on shutdown
+    atomic<size_t> queued;          // tasks sitting in any deque, updated under the deque's lock
+    atomic<unsigned int> nextQueue; // round-robin target for outside submissions
+    bool stopping;                  // set once, under sleepLock, by the destructor
+
+    TaskPool(const TaskPool& other);            // not copyable
+    TaskPool& operator=(const TaskPool& other); // not assignable
+
+    /**
+     * Main loop of worker self.
+     */
+    void WorkerLoop(unsigned int self);
+
+    /**
+     * Runs one queued task, preferring the back of the caller's own deque
+     * and otherwise stealing from the front of another. Returns false if
+     * no task was found.
+     */
+    bool RunOne();
+
+    /**
+     * Wakes every sleeping thread. Taking sleepLock first ensures no
+     * thread is between checking its condition and going to sleep.
+     */
+    void WakeAll();
+
+    /**
+     * Index of the calling thread's deque in this pool, or queues.size()
+     * if the caller is not one of this pool's workers.
+     */
+    size_t CurrentQueue() const;
+};
+
+#endif